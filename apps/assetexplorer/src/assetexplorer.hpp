@@ -21,16 +21,38 @@
 
 #include <fstream>
 #include <filesystem>
+#include <chrono>
+#include <thread>
+#include <ctime>
+#include <iostream>
 
 #include "xengine.hpp"
 
+#include "memory/framearena.hpp"
+#include "profiling/startupprofiler.hpp"
+
+#include "viewportscene.hpp"
+
 using namespace xengine;
 
+// The explorer only redraws when something changed: input, the window size or the viewport scene.
+// Idle frames poll the window events and sleep instead of rendering, pass --always-render to render every frame
+// for comparing the cpu usage of both modes (printed on exit).
 class AssetExplorer : public Application, InputListener {
 public:
     AssetExplorer(int argc, char *argv[])
             : Application(argc, argv) {
+        for (int i = 1; i < argc; i++) {
+            if (std::string(argv[i]) == "--always-render")
+                alwaysRender = true;
+            if (std::string(argv[i]) == "--startup-report" && i + 1 < argc)
+                startupReportPath = argv[i + 1];
+        }
+
         window->setTitle("Asset Explorer");
+
+        // The passes compile their shaders on construction, this is most of the startup time
+        startupProfiler.begin("Render passes");
         auto passes = std::vector<std::shared_ptr<RenderPass>>();
         passes.emplace_back(new GBufferPass(*renderDevice));
         passes.emplace_back(new PhongPass(*renderDevice));
@@ -38,16 +60,38 @@ public:
         pipeline = std::make_unique<FrameGraphPipeline>(*renderDevice);
         pipeline->setPasses(passes);
 
+        startupProfiler.begin("First frame");
+
         window->getInput().addListener(*this);
     }
 
     ~AssetExplorer() {
         window->getInput().removeListener(*this);
+
+        auto wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        auto cpuTime = static_cast<double>(std::clock() - startCpuTime) / CLOCKS_PER_SEC;
+        std::cout << (alwaysRender ? "Always render" : "Event driven")
+                  << " - Rendered frames: " << renderedFrames
+                  << " Skipped frames: " << skippedFrames
+                  << " Wall time: " << wallTime << "s"
+                  << " Cpu time: " << cpuTime << "s"
+                  << " Average cpu usage: " << (wallTime > 0 ? cpuTime / wallTime * 100 : 0) << "%" << std::endl;
+
+        if (!startupReportPath.empty()) {
+            std::ofstream fs(startupReportPath);
+            startupProfiler.writeReport(fs);
+        }
     }
 
 protected:
     void update(float deltaTime) override {
         auto &mouse = window->getInput().getMice().begin()->second;
+        bool buttons = mouse.getButton(xengine::LEFT) || mouse.getButton(xengine::RIGHT) || mouse.getButton(xengine::MIDDLE);
+        if (buttons != mouseButtons) {
+            mouseButtons = buttons;
+            requestRedraw();
+        }
+
         if (mouse.getButton(xengine::LEFT)
             && mouse.position.x > guiWidth + 10) {
             viewRotation = (Quaternion(Vec3f(-mouseDelta.y * 50 * deltaTime, -mouseDelta.x * 50 * deltaTime, 0))
@@ -55,10 +99,33 @@ protected:
         }
         mouseDelta = {};
 
-        drawViewport();
-        drawGui();
+        updateViewportScene();
+        if (viewportScene.isDirty()
+            || window->getRenderTarget(graphicsBackend).getSize() != renderResolution)
+            requestRedraw();
 
-        Application::update(deltaTime);
+        updateCpuUsage();
+
+        if (alwaysRender || redrawFrames > 0) {
+            if (redrawFrames > 0)
+                redrawFrames--;
+
+            drawViewport();
+            drawGui();
+            renderedFrames++;
+
+            Application::update(deltaTime);
+
+            if (startupProfiler.isActive())
+                startupProfiler.end();
+        } else {
+            // Poll the events without presenting, the window keeps showing the last frame
+            skippedFrames++;
+            window->update();
+            std::this_thread::sleep_for(idleInterval);
+        }
+
+        FrameArena::getThreadArena().reset();
     }
 
 private:
@@ -104,12 +171,17 @@ private:
         ImGui::SetWindowSize({guiWidth, (float) target.getSize().y});
         ImGui::SetWindowPos({0, 0});
 
+        ImGui::Text("Rendered frames: %ld Skipped frames: %ld Cpu: %.1f%%", renderedFrames, skippedFrames, cpuUsage);
+
         bool loadAsset = ImGui::Button("Reload Asset");
 
-        std::string buffer = path;
-        buffer.resize(5046);
+        const size_t bufferSize = 5046;
+        auto *buffer = FrameArena::getThreadArena().allocate<char>(bufferSize);
+        auto length = std::min(path.size(), bufferSize - 1);
+        path.copy(buffer, length);
+        buffer[length] = 0;
 
-        if (ImGui::InputText("Path", buffer.data(), buffer.size()))
+        if (ImGui::InputText("Path", buffer, bufferSize))
             path = buffer;
 
         if (loadAsset) {
@@ -172,36 +244,48 @@ private:
         }
     }
 
+    // Redraw the next frames, imgui needs a few frames after an event to settle hover and active states
+    void requestRedraw() {
+        redrawFrames = settleFrames;
+    }
+
+    void updateCpuUsage() {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration<double>(now - sampleTime).count();
+        if (elapsed < 1)
+            return;
+        auto cpu = std::clock();
+        cpuUsage = static_cast<float>(static_cast<double>(cpu - sampleCpuTime) / CLOCKS_PER_SEC / elapsed * 100);
+        sampleTime = now;
+        sampleCpuTime = cpu;
+    }
+
+    void updateViewportScene() {
+        auto winSize = window->getRenderTarget(graphicsBackend).getSize();
+        auto aspectRatio = (float) winSize.x / (float) winSize.y;
+
+        viewportScene.setAspectRatio(aspectRatio);
+        viewportScene.setViewDistance(viewDistance);
+        viewportScene.setRotation(viewRotation);
+        viewportScene.setMesh(mesh.get());
+    }
+
     void drawViewport() {
         auto &target = window->getRenderTarget(graphicsBackend);
         auto winSize = target.getSize();
-        auto aspectRatio = (float) winSize.x / (float) winSize.y;
 
-        Scene s;
-        s.camera.type = xengine::PERSPECTIVE;
-        s.camera.transform.setPosition({0, 0, viewDistance});
-        s.camera.aspectRatio = aspectRatio;
-        s.camera.farClip = 10000;
-
-        s.skybox.color = ColorRGBA::blue();
-
-        auto light = Light(LightType::LIGHT_DIRECTIONAL);
-        light.direction = {0, 0, -1.0f};
-        light.ambient = Vec3f(0.5f);
-        s.lights.emplace_back(light);
-
-        if (mesh) {
-            Material mat;
-            mat.diffuse = ColorRGBA::white(0.1);
-            Scene::Object o(ResourceHandle<Mesh>({}, nullptr, dynamic_cast<Resource *>(mesh.get())),
-                            ResourceHandle<Material>());
-            o.transform = {{}, viewRotation, {1, 1, 1}};
-            s.objects.emplace_back(o);
+        // Reconfiguring the pipeline reallocates its render targets
+        if (renderResolution != winSize) {
+            renderResolution = winSize;
+            pipeline->setRenderResolution(renderResolution);
+        }
+        if (renderSamples != samples) {
+            renderSamples = samples;
+            pipeline->setRenderSamples(renderSamples);
         }
 
-        pipeline->setRenderResolution(winSize);
-        pipeline->setRenderSamples(4);
-        pipeline->render(target, s);
+        pipeline->render(target, viewportScene.getScene());
+        viewportScene.clearDirty();
     }
 
     void onMouseMove(double xPos, double yPos) override {
@@ -209,6 +293,7 @@ private:
         auto &mouse = input.getMice().begin()->second;
         mouseDelta = Vec2d(prevMousePos.x - xPos, prevMousePos.y - yPos);
         prevMousePos = {xPos, yPos};
+        requestRedraw();
     }
 
     void onMouseWheelScroll(double amount) override {
@@ -218,12 +303,25 @@ private:
         } else if (viewDistance > 10000) {
             viewDistance = 10000;
         }
+        requestRedraw();
+    }
+
+    void onKeyDown(KeyboardKey key) override {
+        requestRedraw();
+    }
+
+    void onKeyUp(KeyboardKey key) override {
+        requestRedraw();
     }
 
     std::string path;
     ResourceBundle bundle;
 
-    Scene scene;
+    ViewportScene viewportScene;
+
+    const int samples = 4;
+    Vec2i renderResolution;
+    int renderSamples = 0;
 
     float guiWidth;
 
@@ -236,6 +334,24 @@ private:
     Vec2d prevMousePos;
 
     std::unique_ptr<FrameGraphPipeline> pipeline;
+
+    bool alwaysRender = false;
+    const int settleFrames = 3;
+    const std::chrono::milliseconds idleInterval{10};
+    int redrawFrames = settleFrames;
+    bool mouseButtons = false;
+
+    unsigned long renderedFrames = 0;
+    unsigned long skippedFrames = 0;
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    StartupProfiler startupProfiler;
+    std::string startupReportPath; // Written on exit if set with --startup-report <file>
+    std::clock_t startCpuTime = std::clock();
+    std::chrono::steady_clock::time_point sampleTime = startTime;
+    std::clock_t sampleCpuTime = startCpuTime;
+    float cpuUsage = 0; // Percent of one core over the last second
 };
 
 #endif //XSAMPLES_ASSETEXPLORER_HPP
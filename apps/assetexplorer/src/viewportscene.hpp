@@ -0,0 +1,105 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef XSAMPLES_VIEWPORTSCENE_HPP
+#define XSAMPLES_VIEWPORTSCENE_HPP
+
+#include "xengine.hpp"
+
+using namespace xengine;
+
+// The scene rendered by the asset explorer viewport.
+// The camera, skybox, light and object persist across frames and only the changed properties are written,
+// the dirty flag tells whether the scene differs from the last rendered one.
+class ViewportScene {
+public:
+    ViewportScene() {
+        scene.camera.type = xengine::PERSPECTIVE;
+        scene.camera.farClip = 10000;
+
+        scene.skybox.color = ColorRGBA::blue();
+
+        auto light = Light(LightType::LIGHT_DIRECTIONAL);
+        light.direction = {0, 0, -1.0f};
+        light.ambient = Vec3f(0.5f);
+        scene.lights.emplace_back(light);
+    }
+
+    void setAspectRatio(float value) {
+        if (scene.camera.aspectRatio != value) {
+            scene.camera.aspectRatio = value;
+            dirty = true;
+        }
+    }
+
+    void setViewDistance(float value) {
+        if (viewDistance != value) {
+            viewDistance = value;
+            scene.camera.transform.setPosition({0, 0, viewDistance});
+            dirty = true;
+        }
+    }
+
+    void setRotation(const Vec3f &value) {
+        if (rotation != value) {
+            rotation = value;
+            if (!scene.objects.empty())
+                scene.objects.at(0).transform = {{}, rotation, {1, 1, 1}};
+            dirty = true;
+        }
+    }
+
+    // The mesh buffer must outlive its use in the scene, pass nullptr to remove the object.
+    void setMesh(MeshBuffer *value) {
+        if (mesh == value)
+            return;
+
+        mesh = value;
+        scene.objects.clear();
+        if (mesh != nullptr) {
+            Scene::Object o(ResourceHandle<Mesh>({}, nullptr, dynamic_cast<Resource *>(mesh)),
+                            ResourceHandle<Material>());
+            o.transform = {{}, rotation, {1, 1, 1}};
+            scene.objects.emplace_back(o);
+        }
+        dirty = true;
+    }
+
+    const Scene &getScene() const {
+        return scene;
+    }
+
+    bool isDirty() const {
+        return dirty;
+    }
+
+    void clearDirty() {
+        dirty = false;
+    }
+
+private:
+    Scene scene;
+
+    MeshBuffer *mesh = nullptr;
+    Vec3f rotation;
+    float viewDistance = -1;
+
+    bool dirty = true;
+};
+
+#endif //XSAMPLES_VIEWPORTSCENE_HPP
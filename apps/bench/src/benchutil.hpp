@@ -0,0 +1,49 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_BENCHUTIL_HPP
+#define XSAMPLES_BENCHUTIL_HPP
+
+#include <filesystem>
+#include <sstream>
+#include <fstream>
+#include <memory>
+
+#include "xengine.hpp"
+
+using namespace xengine;
+
+// The asset directory copied into the binary directory by the build, benchmarks are run from there.
+inline std::string getAssetDirectory() {
+    return std::filesystem::current_path().string() + "/assets";
+}
+
+inline std::shared_ptr<Archive> getAssetArchive() {
+    static std::shared_ptr<Archive> archive = std::make_shared<DirectoryArchive>(getAssetDirectory());
+    return archive;
+}
+
+inline std::string readAsset(const std::string &path) {
+    auto stream = getAssetArchive()->open(path);
+    std::stringstream ss;
+    ss << stream->rdbuf();
+    return ss.str();
+}
+
+#endif //XSAMPLES_BENCHUTIL_HPP
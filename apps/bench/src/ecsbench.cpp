@@ -0,0 +1,103 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "benchutil.hpp"
+
+#include "systems/transformanimationsystem.hpp"
+#include "components/transformanimationcomponent.hpp"
+
+// Populates an entity manager the way TransformAnimationSystem sees it in sample0, with n animated transforms.
+static void createAnimatedEntities(EntityManager &entityManager, int64_t count) {
+    auto &componentManager = entityManager.getComponentManager();
+    for (int64_t i = 0; i < count; i++) {
+        auto entity = entityManager.create();
+        TransformComponent transform;
+        transform.transform.setPosition(Vec3f(static_cast<float>(i), 0, 0));
+        componentManager.create<TransformComponent>(entity, transform);
+        componentManager.create<TransformAnimationComponent>(entity, {{0, 1, 0},
+                                                                      {5.57281, 4.985, 7.78}});
+    }
+}
+
+static void BM_ComponentPoolIterate(benchmark::State &state) {
+    EntityManager entityManager;
+    createAnimatedEntities(entityManager, state.range(0));
+    auto &componentManager = entityManager.getComponentManager();
+
+    for (auto _: state) {
+        float sum = 0;
+        for (auto &pair: componentManager.getPool<TransformAnimationComponent>())
+            sum += pair.second.rotation.x;
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ComponentPoolIterate)->Range(64, 64 << 10);
+
+static void BM_ComponentLookup(benchmark::State &state) {
+    EntityManager entityManager;
+    createAnimatedEntities(entityManager, state.range(0));
+    auto &componentManager = entityManager.getComponentManager();
+
+    for (auto _: state) {
+        for (auto &pair: componentManager.getPool<TransformAnimationComponent>()) {
+            auto transform = componentManager.lookup<TransformComponent>(pair.first);
+            benchmark::DoNotOptimize(transform);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ComponentLookup)->Range(64, 64 << 10);
+
+static void BM_ComponentUpdate(benchmark::State &state) {
+    EntityManager entityManager;
+    createAnimatedEntities(entityManager, state.range(0));
+    auto &componentManager = entityManager.getComponentManager();
+
+    for (auto _: state) {
+        for (auto &pair: componentManager.getPool<TransformAnimationComponent>()) {
+            auto transform = componentManager.lookup<TransformComponent>(pair.first);
+            componentManager.update<TransformComponent>(pair.first, transform);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ComponentUpdate)->Range(64, 64 << 10);
+
+static void BM_TransformAnimationSystem(benchmark::State &state) {
+    EntityManager entityManager;
+    createAnimatedEntities(entityManager, state.range(0));
+    TransformAnimationSystem system;
+
+    for (auto _: state) {
+        system.update(1.0f / 60.0f, entityManager);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TransformAnimationSystem)->Range(64, 64 << 10);
@@ -0,0 +1,56 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "render/lightclusters.hpp"
+
+// Stress test for the light clustering with thousands of point lights spread around the camera.
+static void BM_LightClusterBuild(benchmark::State &state) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-100, 100);
+    std::uniform_real_distribution<float> radius(1, 15);
+
+    LightClusterGrid grid;
+    for (int i = 0; i < state.range(0); i++)
+        grid.addLight(position(rng), position(rng), position(rng), radius(rng));
+
+    LightClusterGrid::View view{{0, 1, 0},
+                                {1, 0, 0},
+                                {0, 1, 0},
+                                {0, 0, -1},
+                                60,
+                                16.0f / 9.0f,
+                                0.1f,
+                                200};
+
+    for (auto _: state) {
+        grid.build(view);
+        benchmark::DoNotOptimize(grid.getIndices().data());
+    }
+
+    state.counters["visible"] = static_cast<double>(grid.getStats().visibleLights);
+    state.counters["indices"] = static_cast<double>(grid.getStats().indices);
+    state.counters["maxPerCluster"] = static_cast<double>(grid.getStats().maxLightsPerCluster);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_LightClusterBuild)->RangeMultiplier(4)->Range(1 << 10, 1 << 14)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,73 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "benchutil.hpp"
+
+static void BM_QuaternionFromEuler(benchmark::State &state) {
+    Vec3f euler(5.57281, 4.985, 7.78);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(euler);
+        Quaternion q(euler);
+        benchmark::DoNotOptimize(q);
+    }
+}
+
+BENCHMARK(BM_QuaternionFromEuler);
+
+static void BM_QuaternionMultiply(benchmark::State &state) {
+    Quaternion a(Vec3f(15, 15, 44));
+    Quaternion b(Vec3f(5.57281, 4.985, 7.78));
+    for (auto _: state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        auto q = a * b;
+        benchmark::DoNotOptimize(q);
+    }
+}
+
+BENCHMARK(BM_QuaternionMultiply);
+
+static void BM_TransformApplyRotation(benchmark::State &state) {
+    Transform transform({0, 1, 0}, {15, 15, 44}, {1, 1, 1});
+    Quaternion rotation(Vec3f(0, 1.5f, 0));
+    for (auto _: state) {
+        transform.applyRotation(rotation, true);
+        transform.applyRotation(rotation);
+        benchmark::DoNotOptimize(transform);
+    }
+}
+
+BENCHMARK(BM_TransformApplyRotation);
+
+static void BM_TransformBasisVectors(benchmark::State &state) {
+    Transform transform({0, 1, 0}, {15, 15, 44}, {1, 1, 1});
+    for (auto _: state) {
+        benchmark::DoNotOptimize(transform);
+        auto forward = transform.forward();
+        auto left = transform.left();
+        auto up = transform.up();
+        benchmark::DoNotOptimize(forward);
+        benchmark::DoNotOptimize(left);
+        benchmark::DoNotOptimize(up);
+    }
+}
+
+BENCHMARK(BM_TransformBasisVectors);
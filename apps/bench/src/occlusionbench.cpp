@@ -0,0 +1,86 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <random>
+
+#include "render/occlusionculler.hpp"
+
+// A row of walls in front of the camera hiding part of a field of unit boxes behind it.
+static void BM_OcclusionCull(benchmark::State &state) {
+    // Both windings so that the walls occlude regardless of back face culling
+    std::vector<OcclusionCuller::Vertex> vertices = {{{-1, -1, 0}, {0, 0, 1}},
+                                                     {{1,  -1, 0}, {0, 0, 1}},
+                                                     {{1,  1,  0}, {0, 0, 1}},
+                                                     {{-1, 1,  0}, {0, 0, 1}}};
+    std::vector<uint32_t> indices = {0, 1, 2, 0, 2, 3, 0, 2, 1, 0, 3, 2};
+
+    std::vector<std::array<float, 16>> walls;
+    for (int i = 0; i < 4; i++) {
+        // 6 wide, 4 high, spaced so that gaps remain between them
+        walls.push_back({3, 0, 0, 0,
+                         0, 2, 0, 0,
+                         0, 0, 1, 0,
+                         -12.0f + static_cast<float>(i) * 8.0f, 1, -10, 1});
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> x(-20, 20);
+    std::uniform_real_distribution<float> z(-60, -15);
+    std::vector<OcclusionCuller::Object> objects;
+    for (int i = 0; i < state.range(0); i++) {
+        objects.push_back({{-0.5f, -0.5f, -0.5f},
+                           {0.5f,  0.5f,  0.5f},
+                           {1, 0, 0, 0,
+                            0, 1, 0, 0,
+                            0, 0, 1, 0,
+                            x(rng), 0.5f, z(rng), 1}});
+    }
+    std::vector<uint8_t> occluded(objects.size());
+
+    OcclusionCuller culler;
+    OcclusionCuller::View view{{0,  1, 0},
+                               {1,  0, 0},
+                               {0,  1, 0},
+                               {0,  0, -1},
+                               60,
+                               16.0f / 9.0f,
+                               0.1f,
+                               1000};
+
+    size_t occludedCount = 0;
+    for (auto _: state) {
+        culler.begin(view);
+        for (auto &wall: walls)
+            culler.addOccluder(vertices.data(), vertices.size(), indices.data(), indices.size(), wall.data());
+        culler.render();
+
+        occludedCount = culler.testObjects(objects.data(), objects.size(), occluded.data());
+        benchmark::DoNotOptimize(occludedCount);
+    }
+
+    state.counters["occluded"] = static_cast<double>(occludedCount);
+    state.counters["rasterMs"] = culler.getStats().rasterTime;
+    state.counters["testMs"] = culler.getStats().testTime;
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_OcclusionCull)->RangeMultiplier(4)->Range(1 << 10, 1 << 14)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,194 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "benchutil.hpp"
+
+#include "io/compressedarchive.hpp"
+
+#include "pak/contentpak.hpp"
+
+static void BM_PakCreate(benchmark::State &state) {
+    auto entries = Pak::readEntries(getAssetDirectory());
+
+    size_t bytes = 0;
+    for (auto &pair: entries)
+        bytes += pair.second.size();
+
+    for (auto _: state) {
+        auto chunks = Pak::createPak(entries, state.range(0));
+        benchmark::DoNotOptimize(chunks.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+BENCHMARK(BM_PakCreate)->Arg(0)->Arg(16 * 1024 * 1024)->Unit(benchmark::kMillisecond);
+
+static void BM_PakRead(benchmark::State &state) {
+    auto entries = Pak::readEntries(getAssetDirectory());
+    auto chunks = Pak::createPak(entries, state.range(0));
+
+    std::vector<std::string> chunkData;
+    for (auto &chunk: chunks)
+        chunkData.emplace_back(chunk.begin(), chunk.end());
+
+    size_t bytes = 0;
+    std::vector<char> buffer;
+
+    for (auto _: state) {
+        std::vector<std::unique_ptr<std::istream>> streams;
+        for (auto &data: chunkData)
+            streams.emplace_back(std::make_unique<std::istringstream>(data));
+
+        PakArchive archive(std::move(streams));
+
+        for (auto &pair: entries) {
+            auto stream = archive.open(pair.first);
+            buffer.resize(pair.second.size());
+            stream->read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            bytes += static_cast<size_t>(stream->gcount());
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+BENCHMARK(BM_PakRead)->Arg(0)->Arg(16 * 1024 * 1024)->Unit(benchmark::kMillisecond);
+
+// Compression of all asset entries with a single codec, ratio is stored / raw bytes.
+static void BM_PakCompress(benchmark::State &state, BlockCodec codec, int level) {
+    if (!isCodecAvailable(codec)) {
+        state.SkipWithError("Codec not available in this build");
+        return;
+    }
+
+    auto entries = Pak::readEntries(getAssetDirectory());
+
+    PakCompression::Policy policy;
+    policy.fast = {codec, level};
+    policy.dense = policy.fast;
+    policy.storedExtensions.clear();
+
+    ThreadPool pool;
+    PakCompression::Stats stats;
+    for (auto _: state) {
+        state.PauseTiming();
+        auto copy = entries;
+        state.ResumeTiming();
+        stats = PakCompression::compressEntries(copy, policy, &pool);
+        benchmark::DoNotOptimize(copy);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stats.rawBytes));
+    state.counters["ratio"] = static_cast<double>(stats.storedBytes) / static_cast<double>(stats.rawBytes);
+    state.counters["storedMB"] = static_cast<double>(stats.storedBytes) / (1024.0 * 1024.0);
+}
+
+BENCHMARK_CAPTURE(BM_PakCompress, deflate_fast, CODEC_DEFLATE, 0)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PakCompress, deflate_dense, CODEC_DEFLATE, 9)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PakCompress, lz4_fast, CODEC_LZ4, 0)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PakCompress, lz4_dense, CODEC_LZ4, 9)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PakCompress, zstd_fast, CODEC_ZSTD, 0)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PakCompress, zstd_dense, CODEC_ZSTD, 19)->Unit(benchmark::kMillisecond);
+
+// Cold read of every entry through a CompressedArchive over the pak, throughput counts uncompressed bytes.
+static void BM_PakReadCompressed(benchmark::State &state, BlockCodec codec, int level) {
+    if (!isCodecAvailable(codec)) {
+        state.SkipWithError("Codec not available in this build");
+        return;
+    }
+
+    auto entries = Pak::readEntries(getAssetDirectory());
+
+    std::map<std::string, size_t> sizes;
+    for (auto &pair: entries)
+        sizes[pair.first] = pair.second.size();
+
+    PakCompression::Policy policy;
+    policy.fast = {codec, level};
+    policy.dense = policy.fast;
+
+    auto pool = std::make_shared<ThreadPool>();
+    auto stats = PakCompression::compressEntries(entries, policy, pool.get());
+    auto chunks = Pak::createPak(entries, 0);
+
+    std::vector<std::string> chunkData;
+    for (auto &chunk: chunks)
+        chunkData.emplace_back(chunk.begin(), chunk.end());
+
+    size_t bytes = 0;
+    std::vector<char> buffer;
+
+    for (auto _: state) {
+        std::vector<std::unique_ptr<std::istream>> streams;
+        for (auto &data: chunkData)
+            streams.emplace_back(std::make_unique<std::istringstream>(data));
+
+        CompressedArchive archive(std::make_unique<PakArchive>(std::move(streams)), pool);
+
+        for (auto &pair: sizes) {
+            auto stream = archive.open(pair.first);
+            buffer.resize(pair.second);
+            stream->read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            bytes += static_cast<size_t>(stream->gcount());
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.counters["ratio"] = static_cast<double>(stats.storedBytes) / static_cast<double>(stats.rawBytes);
+    state.counters["threads"] = static_cast<double>(pool->getThreadCount());
+}
+
+BENCHMARK_CAPTURE(BM_PakReadCompressed, none, CODEC_NONE, 0)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PakReadCompressed, deflate, CODEC_DEFLATE, 0)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PakReadCompressed, lz4, CODEC_LZ4, 0)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PakReadCompressed, zstd, CODEC_ZSTD, 0)->Unit(benchmark::kMillisecond);
+
+// Content addressed build of the assets with every file present twice, as happens with copied textures.
+// The incremental variant rebuilds against the previous manifest after one entry changed,
+// writtenMB is what a patch would have to upload.
+static void BM_PakContentBuild(benchmark::State &state) {
+    auto incremental = state.range(0) != 0;
+
+    auto entries = Pak::readEntries(getAssetDirectory());
+    auto copies = entries;
+    for (auto &pair: copies)
+        entries["/copy" + pair.first] = pair.second;
+
+    auto previous = ContentPak::build(entries, nullptr, 16 * 1024 * 1024).manifest;
+    if (incremental)
+        entries.begin()->second.push_back(0);
+
+    ContentPak::Stats stats;
+    for (auto _: state) {
+        auto result = ContentPak::build(entries, incremental ? &previous : nullptr, 16 * 1024 * 1024);
+        stats = result.stats;
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stats.entryBytes));
+    state.counters["entryMB"] = static_cast<double>(stats.entryBytes) / (1024.0 * 1024.0);
+    state.counters["duplicateMB"] = static_cast<double>(stats.duplicateBytes) / (1024.0 * 1024.0);
+    state.counters["writtenMB"] = static_cast<double>(stats.writtenBytes) / (1024.0 * 1024.0);
+    state.counters["keptChunks"] = static_cast<double>(stats.keptChunks);
+}
+
+BENCHMARK(BM_PakContentBuild)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,39 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "benchutil.hpp"
+
+static void BM_ResourceImport(benchmark::State &state, const std::string &path) {
+    auto data = readAsset(path);
+    auto extension = std::filesystem::path(path).extension().string();
+
+    for (auto _: state) {
+        std::istringstream stream(data);
+        auto bundle = ResourceImporter().import(stream, extension);
+        benchmark::DoNotOptimize(bundle);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+
+BENCHMARK_CAPTURE(BM_ResourceImport, mesh_obj, std::string("/meshes/plane.obj"))->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ResourceImport, material_json, std::string("/materials/containermaterial.json"))->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ResourceImport, audio_wav, std::string("/audio/Farbro-Tectonic-Mono.wav"))->Unit(benchmark::kMillisecond);
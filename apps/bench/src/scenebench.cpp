@@ -0,0 +1,54 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "benchutil.hpp"
+
+static void BM_SceneDeserialize(benchmark::State &state) {
+    ResourceRegistry::getDefaultRegistry().setArchive(getAssetArchive());
+
+    auto json = readAsset("/scene.json");
+
+    for (auto _: state) {
+        std::istringstream stream(json);
+        auto scene = JsonProtocol().deserialize(stream);
+        benchmark::DoNotOptimize(scene);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * json.size()));
+}
+
+BENCHMARK(BM_SceneDeserialize)->Unit(benchmark::kMicrosecond);
+
+static void BM_SceneInstantiate(benchmark::State &state) {
+    ResourceRegistry::getDefaultRegistry().setArchive(getAssetArchive());
+
+    auto json = readAsset("/scene.json");
+    std::istringstream stream(json);
+    auto scene = JsonProtocol().deserialize(stream);
+
+    for (auto _: state) {
+        EntityManager entityManager;
+        entityManager << scene;
+        benchmark::DoNotOptimize(entityManager);
+    }
+}
+
+BENCHMARK(BM_SceneInstantiate)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,68 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "scripting/nativescriptruntime.hpp"
+
+// Entities spread over 8 script classes, half of them synced. The second argument toggles batching,
+// transitions is the number of runtime calls per frame which dominates with a managed runtime.
+static void BM_ScriptBatchDispatch(benchmark::State &state) {
+    auto count = static_cast<int>(state.range(0));
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> scriptClass(0, 7);
+
+    std::vector<std::string> classes;
+    NativeScriptRuntime runtime;
+    for (int i = 0; i < 8; i++) {
+        classes.emplace_back("script.dll:Controller" + std::to_string(i));
+        runtime.registerClass(classes.back(), [](ScriptEntityData *entities, size_t n, float deltaTime) {
+            for (size_t e = 0; e < n; e++)
+                entities[e].position[1] += deltaTime;
+        });
+    }
+
+    std::vector<int> assignment;
+    for (int i = 0; i < count; i++)
+        assignment.emplace_back(scriptClass(rng));
+
+    ScriptBatcher batcher;
+    batcher.setBatching(state.range(1) != 0);
+    for (auto _: state) {
+        batcher.begin();
+        for (int i = 0; i < count; i++) {
+            auto &data = batcher.add(i, classes.at(assignment.at(i)), 0, i % 2 == 0);
+            data = {};
+            data.entity = i;
+        }
+        batcher.dispatch(runtime, 0.016f);
+        benchmark::DoNotOptimize(batcher.getEntities().data());
+    }
+
+    state.counters["transitions"] = static_cast<double>(batcher.getStats().transitions);
+    state.counters["unbatchedTransitions"] = static_cast<double>(batcher.getStats().unbatchedTransitions);
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_ScriptBatchDispatch)
+        ->ArgsProduct({{1 << 10, 1 << 14}, {0, 1}})
+        ->Unit(benchmark::kMicrosecond);
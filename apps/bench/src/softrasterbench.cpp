@@ -0,0 +1,109 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "render/softrasterizer.hpp"
+
+// A field of unit cubes in front of the camera, the amount of cubes controls the overdraw.
+static void addCube(std::vector<SoftRasterizer::Vertex> &vertices, std::vector<uint32_t> &indices) {
+    const float faces[6][3] = {{1,  0,  0},
+                               {-1, 0,  0},
+                               {0,  1,  0},
+                               {0,  -1, 0},
+                               {0,  0,  1},
+                               {0,  0,  -1}};
+    const float corners[4][2] = {{-1, -1},
+                                 {1,  -1},
+                                 {1,  1},
+                                 {-1, 1}};
+    for (auto &n: faces) {
+        // Tangents chosen so that u x v = n, the faces are counter clockwise seen from outside
+        float u[3] = {n[1] + n[2], 0, n[0]};
+        float v[3] = {n[1] * u[2] - n[2] * u[1], n[2] * u[0] - n[0] * u[2], n[0] * u[1] - n[1] * u[0]};
+        auto base = static_cast<uint32_t>(vertices.size());
+        for (auto &corner: corners) {
+            SoftRasterizer::Vertex vertex{};
+            for (int i = 0; i < 3; i++) {
+                vertex.position[i] = 0.5f * (n[i] + corner[0] * u[i] - corner[1] * v[i]);
+                vertex.normal[i] = n[i];
+            }
+            vertices.emplace_back(vertex);
+        }
+        indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+}
+
+static void BM_SoftRasterizerCubes(benchmark::State &state) {
+    std::vector<SoftRasterizer::Vertex> vertices;
+    std::vector<uint32_t> indices;
+    addCube(vertices, indices);
+
+    SoftRasterizer rasterizer(static_cast<int>(state.range(1)), static_cast<int>(state.range(1) * 9 / 16));
+    rasterizer.setView({{0, 5, 20},
+                        {1, 0, 0},
+                        {0, 0.97f, -0.25f},
+                        {0, -0.25f, -0.97f},
+                        60,
+                        16.0f / 9.0f,
+                        0.1f,
+                        200});
+    rasterizer.setClearColor(0.15f, 0.15f, 0.15f);
+
+    SoftRasterizer::Light sun;
+    sun.kind = SoftRasterizer::DIRECTIONAL;
+    sun.direction[0] = -0.3f;
+    sun.direction[2] = -0.5f;
+    SoftRasterizer::Light point;
+    point.position[1] = 3;
+    point.linear = 0.09f;
+    point.quadratic = 0.032f;
+    rasterizer.setLights({sun, point});
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-15, 15);
+    for (int i = 0; i < state.range(0); i++) {
+        float model[16] = {1, 0, 0, 0,
+                           0, 1, 0, 0,
+                           0, 0, 1, 0,
+                           position(rng), position(rng) * 0.1f, position(rng) - 5, 1};
+        SoftRasterizer::Material material;
+        material.diffuse[0] = static_cast<float>(i % 3) / 2;
+        rasterizer.draw(vertices.data(), vertices.size(), indices.data(), indices.size(), model,
+                        rasterizer.addMaterial(material));
+    }
+
+    for (auto _: state) {
+        rasterizer.render();
+        benchmark::DoNotOptimize(rasterizer.getColor().data());
+    }
+
+    auto &stats = rasterizer.getStats();
+    state.counters["vertexMs"] = stats.vertexTime;
+    state.counters["setupMs"] = stats.setupTime;
+    state.counters["rasterMs"] = stats.rasterTime;
+    state.counters["shadedPixels"] = static_cast<double>(stats.shadedPixels);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(stats.triangles));
+}
+
+BENCHMARK(BM_SoftRasterizerCubes)
+        ->ArgsProduct({{100, 1000, 4000}, {640, 1280}})
+        ->Unit(benchmark::kMillisecond);
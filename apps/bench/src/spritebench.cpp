@@ -0,0 +1,58 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "render/spritequeue.hpp"
+
+struct BenchSprite {
+    float src[4];
+    float dst[4];
+    uint8_t color[4];
+};
+
+// A hud like workload, sprites interleave 8 textures on 4 layers in submission order.
+static void BM_SpriteQueueFlush(benchmark::State &state) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> texture(0, 7);
+    std::uniform_int_distribution<int> layer(0, 3);
+
+    static const int textures[8] = {};
+    std::vector<std::pair<int, int>> sprites;
+    for (int i = 0; i < state.range(0); i++)
+        sprites.emplace_back(texture(rng), layer(rng));
+
+    SpriteQueue<BenchSprite> queue;
+    BenchSprite sprite{};
+    for (auto _: state) {
+        for (auto &s: sprites)
+            queue.push(&textures[s.first], s.second, sprite);
+        size_t submitted = 0;
+        queue.flush([&submitted](const void *, const BenchSprite &, bool) { submitted++; });
+        benchmark::DoNotOptimize(submitted);
+    }
+
+    state.counters["batches"] = static_cast<double>(queue.getStats().batches);
+    state.counters["unsortedBatches"] = static_cast<double>(queue.getStats().unsortedBatches);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SpriteQueueFlush)->RangeMultiplier(4)->Range(1 << 10, 1 << 16)->Unit(benchmark::kMicrosecond);
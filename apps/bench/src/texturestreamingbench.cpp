@@ -0,0 +1,72 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "render/texturestreamer.hpp"
+
+static TextureStreamer::Image createImage(int size) {
+    TextureStreamer::Image ret;
+    ret.width = size;
+    ret.height = size;
+    ret.pixels.resize(static_cast<size_t>(size) * static_cast<size_t>(size) * 4);
+    for (size_t i = 0; i < ret.pixels.size(); i++)
+        ret.pixels[i] = static_cast<uint8_t>(i * 31);
+    return ret;
+}
+
+// Building the complete chain below a level, the work of a single load job without the decode.
+static void BM_TextureMipChain(benchmark::State &state) {
+    auto image = createImage(static_cast<int>(state.range(0)));
+    for (auto _: state) {
+        auto level = TextureStreamer::downsample(image);
+        while (level.width > 1 || level.height > 1)
+            level = TextureStreamer::downsample(level);
+        benchmark::DoNotOptimize(level.pixels.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(image.pixels.size()));
+}
+
+BENCHMARK(BM_TextureMipChain)->RangeMultiplier(2)->Range(256, 2048)->Unit(benchmark::kMicrosecond);
+
+// Time and memory until 32 textures of 1024x1024 are ready to be drawn.
+// Arg 0 makes the whole chain the coarse tail which matches loading every texture eagerly at scene start,
+// Arg 1 starts with the 64 pixel tail of the streamer.
+static void BM_TextureStartup(benchmark::State &state) {
+    const int textureCount = 32;
+    auto image = std::make_shared<TextureStreamer::Image>(createImage(1024));
+    ThreadPool pool;
+
+    size_t residentBytes = 0;
+    for (auto _: state) {
+        TextureStreamer streamer(pool, SIZE_MAX, state.range(0) == 0 ? 1024 : 64, textureCount);
+        for (int i = 0; i < textureCount; i++) {
+            streamer.add([image]() {
+                return *image;
+            });
+        }
+        streamer.update();
+        streamer.flush();
+        residentBytes = streamer.getStats().residentBytes;
+    }
+
+    state.counters["residentMiB"] = static_cast<double>(residentBytes) / (1024.0 * 1024.0);
+}
+
+BENCHMARK(BM_TextureStartup)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,190 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include "benchutil.hpp"
+
+#include "math/transformstreams.hpp"
+
+// The AoS benchmarks run the engine math over an array of the same size, the SoA variants the bulk kernels.
+// XSAMPLES_CPU=scalar selects the baseline build of the kernels instead of the avx2 variant.
+
+static Vec3f getEuler(size_t i) {
+    return {static_cast<float>(i % 360), static_cast<float>((i * 7) % 360), static_cast<float>((i * 13) % 360)};
+}
+
+static Vec3Streams createEulerStreams(size_t count, size_t offset = 0) {
+    Vec3Streams ret;
+    for (size_t i = 0; i < count; i++) {
+        auto euler = getEuler(i + offset);
+        ret.push_back(euler.x, euler.y, euler.z);
+    }
+    return ret;
+}
+
+static QuaternionStreams createQuaternionStreams(size_t count, size_t offset = 0) {
+    QuaternionStreams ret;
+    TransformKernels::quaternionFromEuler(createEulerStreams(count, offset), 1, ret);
+    return ret;
+}
+
+// The kernels have to follow the engine conventions (degrees, euler order, Hamilton product),
+// the SoA benchmarks fail if the results differ from the engine math. q and -q are the same rotation.
+static bool matchesEngine(const QuaternionStreams &streams, const std::vector<Quaternion> &expected) {
+    const float tolerance = 1e-5f;
+    for (size_t i = 0; i < expected.size(); i++) {
+        auto &q = expected[i];
+        float sign = streams.w[i] * q.w + streams.x[i] * q.x + streams.y[i] * q.y + streams.z[i] * q.z < 0 ? -1.0f : 1.0f;
+        if (std::fabs(streams.w[i] * sign - q.w) > tolerance
+            || std::fabs(streams.x[i] * sign - q.x) > tolerance
+            || std::fabs(streams.y[i] * sign - q.y) > tolerance
+            || std::fabs(streams.z[i] * sign - q.z) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+static void BM_AoSQuaternionFromEuler(benchmark::State &state) {
+    auto count = static_cast<size_t>(state.range(0));
+    std::vector<Vec3f> euler;
+    for (size_t i = 0; i < count; i++)
+        euler.emplace_back(getEuler(i));
+    std::vector<Quaternion> out(count);
+    for (auto _: state) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = Quaternion(euler[i]);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_AoSQuaternionFromEuler)->RangeMultiplier(4)->Range(64, 16384);
+
+static void BM_SoAQuaternionFromEuler(benchmark::State &state) {
+    auto count = static_cast<size_t>(state.range(0));
+    auto euler = createEulerStreams(count);
+    QuaternionStreams out;
+    TransformKernels::quaternionFromEuler(euler, 1, out);
+    std::vector<Quaternion> expected;
+    for (size_t i = 0; i < count; i++)
+        expected.emplace_back(getEuler(i));
+    if (!matchesEngine(out, expected)) {
+        state.SkipWithError("Kernel result differs from Quaternion(Vec3f)");
+        return;
+    }
+    for (auto _: state) {
+        TransformKernels::quaternionFromEuler(euler, 1, out);
+        benchmark::DoNotOptimize(out.x.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SoAQuaternionFromEuler)->RangeMultiplier(4)->Range(64, 16384);
+
+static void BM_AoSQuaternionMultiply(benchmark::State &state) {
+    auto count = static_cast<size_t>(state.range(0));
+    std::vector<Quaternion> a, b;
+    for (size_t i = 0; i < count; i++) {
+        a.emplace_back(getEuler(i));
+        b.emplace_back(getEuler(i + 1));
+    }
+    std::vector<Quaternion> out(count);
+    for (auto _: state) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = a[i] * b[i];
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_AoSQuaternionMultiply)->RangeMultiplier(4)->Range(64, 16384);
+
+static void BM_SoAQuaternionMultiply(benchmark::State &state) {
+    auto count = static_cast<size_t>(state.range(0));
+    auto a = createQuaternionStreams(count);
+    auto b = createQuaternionStreams(count, 1);
+    QuaternionStreams out;
+    TransformKernels::quaternionMultiply(a, b, out);
+    std::vector<Quaternion> expected;
+    for (size_t i = 0; i < count; i++)
+        expected.emplace_back(Quaternion(getEuler(i)) * Quaternion(getEuler(i + 1)));
+    if (!matchesEngine(out, expected)) {
+        state.SkipWithError("Kernel result differs from Quaternion::operator*");
+        return;
+    }
+    for (auto _: state) {
+        TransformKernels::quaternionMultiply(a, b, out);
+        benchmark::DoNotOptimize(out.x.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SoAQuaternionMultiply)->RangeMultiplier(4)->Range(64, 16384);
+
+static void BM_SoAQuaternionNormalize(benchmark::State &state) {
+    auto q = createQuaternionStreams(static_cast<size_t>(state.range(0)));
+    for (auto _: state) {
+        TransformKernels::quaternionNormalize(q);
+        benchmark::DoNotOptimize(q.x.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SoAQuaternionNormalize)->RangeMultiplier(4)->Range(64, 16384);
+
+static void BM_AoSTransformModel(benchmark::State &state) {
+    auto count = static_cast<size_t>(state.range(0));
+    std::vector<Transform> transforms;
+    for (size_t i = 0; i < count; i++)
+        transforms.emplace_back(Vec3f(static_cast<float>(i), 1, 0), getEuler(i), Vec3f(1, 2, 1));
+    for (auto _: state) {
+        for (size_t i = 0; i < count; i++) {
+            auto model = transforms[i].model();
+            benchmark::DoNotOptimize(model);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_AoSTransformModel)->RangeMultiplier(4)->Range(64, 16384);
+
+static void BM_SoATransformCompose(benchmark::State &state) {
+    auto count = static_cast<size_t>(state.range(0));
+    TransformStreams transforms;
+    transforms.resize(count);
+    transforms.rotation = createQuaternionStreams(count);
+    for (size_t i = 0; i < count; i++) {
+        transforms.position.x[i] = static_cast<float>(i);
+        transforms.position.y[i] = 1;
+        transforms.scale.x[i] = 1;
+        transforms.scale.y[i] = 2;
+        transforms.scale.z[i] = 1;
+    }
+    std::vector<float> out(count * 16);
+    for (auto _: state) {
+        TransformKernels::composeMatrices(transforms, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SoATransformCompose)->RangeMultiplier(4)->Range(64, 16384);
@@ -0,0 +1,137 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_THREADPOOL_HPP
+#define XSAMPLES_THREADPOOL_HPP
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+// Fixed set of worker threads executing queued tasks in submission order.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+        for (size_t i = 0; i < threads; i++)
+            workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            shutdown = true;
+        }
+        wake.notify_all();
+        for (auto &worker: workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    template<typename F>
+    auto submit(F &&task) -> std::future<decltype(task())> {
+        auto packaged = std::make_shared<std::packaged_task<decltype(task())()>>(std::forward<F>(task));
+        auto ret = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            tasks.emplace_back([packaged]() { (*packaged)(); });
+        }
+        wake.notify_one();
+        return ret;
+    }
+
+    /**
+     * Call fn(i) for every i in [0, count) and return once all calls finished.
+     * The calling thread takes part, so this may be used from inside a pool task.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)> &fn) {
+        if (count == 0)
+            return;
+
+        struct State {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto state = std::make_shared<State>();
+        auto count_ = count;
+
+        auto run = [state, count_, &fn]() {
+            size_t completed = 0;
+            for (auto i = state->next++; i < count_; i = state->next++) {
+                fn(i);
+                completed++;
+            }
+            if (completed > 0 && state->done.fetch_add(completed) + completed == count_) {
+                std::lock_guard<std::mutex> guard(state->mutex);
+                state->finished.notify_all();
+            }
+        };
+
+        auto helpers = std::min(count - 1, workers.size());
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            for (size_t i = 0; i < helpers; i++)
+                tasks.emplace_back(run);
+        }
+        wake.notify_all();
+
+        run();
+
+        // fn may only be referenced until every index is done, helpers starting later find no work left
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&state, count]() { return state->done == count; });
+    }
+
+    size_t getThreadCount() const {
+        return workers.size();
+    }
+
+private:
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this]() { return shutdown || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool shutdown = false;
+};
+
+#endif //XSAMPLES_THREADPOOL_HPP
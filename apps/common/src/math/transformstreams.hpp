@@ -0,0 +1,395 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_TRANSFORMSTREAMS_HPP
+#define XSAMPLES_TRANSFORMSTREAMS_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "platform/cpufeatures.hpp"
+
+// Structure of arrays transform data, every component is a contiguous stream of floats
+// so that the kernels below process a whole stream per instruction set lane.
+struct Vec3Streams {
+    std::vector<float> x, y, z;
+
+    void resize(size_t count) {
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+    }
+
+    void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+    }
+
+    void push_back(float vx, float vy, float vz) {
+        x.push_back(vx);
+        y.push_back(vy);
+        z.push_back(vz);
+    }
+
+    size_t size() const {
+        return x.size();
+    }
+};
+
+struct QuaternionStreams {
+    std::vector<float> x, y, z, w;
+
+    void resize(size_t count) {
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+        w.resize(count, 1);
+    }
+
+    void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+        w.clear();
+    }
+
+    void push_back(float vx, float vy, float vz, float vw) {
+        x.push_back(vx);
+        y.push_back(vy);
+        z.push_back(vz);
+        w.push_back(vw);
+    }
+
+    size_t size() const {
+        return x.size();
+    }
+};
+
+struct TransformStreams {
+    Vec3Streams position;
+    QuaternionStreams rotation;
+    Vec3Streams scale;
+
+    void resize(size_t count) {
+        position.resize(count);
+        rotation.resize(count);
+        scale.resize(count);
+    }
+
+    size_t size() const {
+        return position.size();
+    }
+};
+
+// Bulk quaternion and transform math over the streams, matching the conventions of the engine math:
+// euler angles in degrees applied like glm::quat(vec3), Hamilton products and column major matrices.
+// Every kernel is a plain loop compiled twice, the default build vectorizes it for the baseline
+// instruction set (SSE2 on x86-64, NEON on aarch64) and the avx2 variant is selected at runtime.
+// Outputs may alias the inputs of the same element, the streams of one argument must have equal sizes.
+class TransformKernels {
+public:
+    /**
+     * @param euler Angles in degrees, multiplied by scale before the conversion
+     */
+    static void quaternionFromEuler(const Vec3Streams &euler, float scale, QuaternionStreams &out) {
+        out.resize(euler.size());
+        Args args{};
+        args.count = euler.size();
+        args.in[0] = euler.x.data();
+        args.in[1] = euler.y.data();
+        args.in[2] = euler.z.data();
+        setOut(args, out);
+        args.scale = scale;
+        if (useAvx2())
+            fromEulerAvx2(args);
+        else
+            fromEulerDefault(args);
+    }
+
+    // out = a * b, applying b first like the engine quaternion product
+    static void quaternionMultiply(const QuaternionStreams &a, const QuaternionStreams &b, QuaternionStreams &out) {
+        out.resize(a.size());
+        Args args{};
+        args.count = a.size();
+        setIn(args, 0, a);
+        setIn(args, 4, b);
+        setOut(args, out);
+        if (useAvx2())
+            multiplyAvx2(args);
+        else
+            multiplyDefault(args);
+    }
+
+    // Zero quaternions stay zero instead of producing nans
+    static void quaternionNormalize(QuaternionStreams &q) {
+        Args args{};
+        args.count = q.size();
+        setIn(args, 0, q);
+        setOut(args, q);
+        if (useAvx2())
+            normalizeAvx2(args);
+        else
+            normalizeDefault(args);
+    }
+
+    // out += v * scale
+    static void addScaled(Vec3Streams &out, const Vec3Streams &v, float scale) {
+        Args args{};
+        args.count = out.size();
+        args.in[0] = v.x.data();
+        args.in[1] = v.y.data();
+        args.in[2] = v.z.data();
+        args.out[0] = out.x.data();
+        args.out[1] = out.y.data();
+        args.out[2] = out.z.data();
+        args.scale = scale;
+        if (useAvx2())
+            addScaledAvx2(args);
+        else
+            addScaledDefault(args);
+    }
+
+    /**
+     * Compose translation * rotation * scale for every transform.
+     *
+     * @param out 16 floats per transform, column major
+     */
+    static void composeMatrices(const TransformStreams &transforms, float *out) {
+        Args args{};
+        args.count = transforms.size();
+        args.in[0] = transforms.position.x.data();
+        args.in[1] = transforms.position.y.data();
+        args.in[2] = transforms.position.z.data();
+        setIn(args, 3, transforms.rotation);
+        args.in[7] = transforms.scale.x.data();
+        args.in[8] = transforms.scale.y.data();
+        args.in[9] = transforms.scale.z.data();
+        args.matrices = out;
+        if (useAvx2())
+            composeAvx2(args);
+        else
+            composeDefault(args);
+    }
+
+private:
+    struct Args {
+        size_t count;
+        const float *in[10];
+        float *out[4];
+        float *matrices;
+        float scale;
+    };
+
+    static bool useAvx2() {
+        return getCpuLevel() == CPU_AVX2;
+    }
+
+    static void setIn(Args &args, int offset, const QuaternionStreams &q) {
+        args.in[offset] = q.x.data();
+        args.in[offset + 1] = q.y.data();
+        args.in[offset + 2] = q.z.data();
+        args.in[offset + 3] = q.w.data();
+    }
+
+    static void setOut(Args &args, QuaternionStreams &q) {
+        args.out[0] = q.x.data();
+        args.out[1] = q.y.data();
+        args.out[2] = q.z.data();
+        args.out[3] = q.w.data();
+    }
+
+    /**
+     * Sine and cosine for the loops, std::sin and std::cos are library calls which prevent vectorization.
+     * The argument is reduced to [-pi/2, pi/2] and evaluated with the Taylor series up to x^11 / x^12,
+     * the error is below 1e-6 which is the precision of the float result anyway.
+     * Selects on float comparisons are not if-converted because the comparison may trap,
+     * the reduction uses min and copysign instead.
+     */
+    static inline void sinCos(float x, float &s, float &c) {
+        const float pi = 3.14159265358979f;
+        auto k = x * (0.5f / pi);
+        auto n = static_cast<float>(static_cast<int>(k + std::copysign(0.5f, k)));
+        x -= n * (2 * pi); // [-pi, pi]
+
+        // Reflect into [-pi/2, pi/2], the sine is symmetric around +-pi/2 and the cosine changes its sign
+        auto magnitude = std::fabs(x);
+        auto reflected = std::copysign(std::min(magnitude, pi - magnitude), x);
+        auto sign = std::copysign(1.0f, pi * 0.5f - magnitude);
+
+        auto x2 = reflected * reflected;
+        s = reflected * (1 + x2 * (-1.0f / 6 + x2 * (1.0f / 120 + x2 * (-1.0f / 5040
+                + x2 * (1.0f / 362880 + x2 * (-1.0f / 39916800))))));
+        c = sign * (1 + x2 * (-1.0f / 2 + x2 * (1.0f / 24 + x2 * (-1.0f / 720
+                + x2 * (1.0f / 40320 + x2 * (-1.0f / 3628800 + x2 * (1.0f / 479001600)))))));
+    }
+
+    /**
+     * 1 / sqrt(x) for x > 0, std::sqrt may set errno and the branch for that keeps the loop from vectorizing.
+     * Three newton steps from the bit level estimate reach the precision of a float.
+     */
+    static inline float inverseSqrt(float x) {
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        bits = 0x5f3759df - (bits >> 1);
+        float y;
+        std::memcpy(&y, &bits, sizeof(y));
+        y = y * (1.5f - 0.5f * x * y * y);
+        y = y * (1.5f - 0.5f * x * y * y);
+        return y * (1.5f - 0.5f * x * y * y);
+    }
+
+#define XSAMPLES_FROM_EULER_LOOP                                                                       \
+        const float *ex = args.in[0], *ey = args.in[1], *ez = args.in[2];                              \
+        float *qx = args.out[0], *qy = args.out[1], *qz = args.out[2], *qw = args.out[3];              \
+        const float halfRadians = 3.14159265358979f / 360.0f * args.scale;                             \
+        XSAMPLES_IVDEP                                                                                 \
+        for (size_t i = 0; i < args.count; i++) {                                                      \
+            float sx, cx, sy, cy, sz, cz;                                                              \
+            sinCos(ex[i] * halfRadians, sx, cx);                                                       \
+            sinCos(ey[i] * halfRadians, sy, cy);                                                       \
+            sinCos(ez[i] * halfRadians, sz, cz);                                                       \
+            qx[i] = sx * cy * cz - cx * sy * sz;                                                       \
+            qy[i] = cx * sy * cz + sx * cy * sz;                                                       \
+            qz[i] = cx * cy * sz - sx * sy * cz;                                                       \
+            qw[i] = cx * cy * cz + sx * sy * sz;                                                       \
+        }
+
+#define XSAMPLES_MULTIPLY_LOOP                                                                         \
+        const float *pax = args.in[0], *pay = args.in[1], *paz = args.in[2], *paw = args.in[3];        \
+        const float *pbx = args.in[4], *pby = args.in[5], *pbz = args.in[6], *pbw = args.in[7];        \
+        float *qx = args.out[0], *qy = args.out[1], *qz = args.out[2], *qw = args.out[3];              \
+        XSAMPLES_IVDEP                                                                                 \
+        for (size_t i = 0; i < args.count; i++) {                                                      \
+            float ax = pax[i], ay = pay[i], az = paz[i], aw = paw[i];                                  \
+            float bx = pbx[i], by = pby[i], bz = pbz[i], bw = pbw[i];                                  \
+            qx[i] = aw * bx + ax * bw + ay * bz - az * by;                                             \
+            qy[i] = aw * by + ay * bw + az * bx - ax * bz;                                             \
+            qz[i] = aw * bz + az * bw + ax * by - ay * bx;                                             \
+            qw[i] = aw * bw - ax * bx - ay * by - az * bz;                                             \
+        }
+
+#define XSAMPLES_NORMALIZE_LOOP                                                                        \
+        float *qx = args.out[0], *qy = args.out[1], *qz = args.out[2], *qw = args.out[3];              \
+        XSAMPLES_IVDEP                                                                                 \
+        for (size_t i = 0; i < args.count; i++) {                                                      \
+            float x = qx[i], y = qy[i], z = qz[i], w = qw[i];                                          \
+            float inverse = inverseSqrt(x * x + y * y + z * z + w * w + 1e-30f);                       \
+            qx[i] = x * inverse;                                                                       \
+            qy[i] = y * inverse;                                                                       \
+            qz[i] = z * inverse;                                                                       \
+            qw[i] = w * inverse;                                                                       \
+        }
+
+#define XSAMPLES_ADD_SCALED_LOOP                                                                       \
+        const float *vx = args.in[0], *vy = args.in[1], *vz = args.in[2];                              \
+        float *ox = args.out[0], *oy = args.out[1], *oz = args.out[2];                                 \
+        const float scale = args.scale;                                                                \
+        XSAMPLES_IVDEP                                                                                 \
+        for (size_t i = 0; i < args.count; i++) {                                                      \
+            ox[i] += vx[i] * scale;                                                                    \
+            oy[i] += vy[i] * scale;                                                                    \
+            oz[i] += vz[i] * scale;                                                                    \
+        }
+
+#define XSAMPLES_COMPOSE_LOOP                                                                          \
+        const float *px = args.in[0], *py = args.in[1], *pz = args.in[2];                              \
+        const float *qx = args.in[3], *qy = args.in[4], *qz = args.in[5], *qw = args.in[6];            \
+        const float *psx = args.in[7], *psy = args.in[8], *psz = args.in[9];                           \
+        float *matrices = args.matrices;                                                               \
+        XSAMPLES_IVDEP                                                                                 \
+        for (size_t i = 0; i < args.count; i++) {                                                      \
+            float x = qx[i], y = qy[i], z = qz[i], w = qw[i];                                          \
+            float sx = psx[i], sy = psy[i], sz = psz[i];                                               \
+            auto *m = matrices + i * 16;                                                               \
+            m[0] = (1 - 2 * (y * y + z * z)) * sx;                                                      \
+            m[1] = 2 * (x * y + z * w) * sx;                                                            \
+            m[2] = 2 * (x * z - y * w) * sx;                                                            \
+            m[3] = 0;                                                                                   \
+            m[4] = 2 * (x * y - z * w) * sy;                                                            \
+            m[5] = (1 - 2 * (x * x + z * z)) * sy;                                                      \
+            m[6] = 2 * (y * z + x * w) * sy;                                                            \
+            m[7] = 0;                                                                                   \
+            m[8] = 2 * (x * z + y * w) * sz;                                                            \
+            m[9] = 2 * (y * z - x * w) * sz;                                                            \
+            m[10] = (1 - 2 * (x * x + y * y)) * sz;                                                     \
+            m[11] = 0;                                                                                  \
+            m[12] = px[i];                                                                             \
+            m[13] = py[i];                                                                             \
+            m[14] = pz[i];                                                                             \
+            m[15] = 1;                                                                                  \
+        }
+
+    static void fromEulerDefault(const Args &args) {
+        XSAMPLES_FROM_EULER_LOOP
+    }
+
+    XSAMPLES_TARGET("avx2,fma")
+    static void fromEulerAvx2(const Args &args) {
+        XSAMPLES_FROM_EULER_LOOP
+    }
+
+    static void multiplyDefault(const Args &args) {
+        XSAMPLES_MULTIPLY_LOOP
+    }
+
+    XSAMPLES_TARGET("avx2,fma")
+    static void multiplyAvx2(const Args &args) {
+        XSAMPLES_MULTIPLY_LOOP
+    }
+
+    static void normalizeDefault(const Args &args) {
+        XSAMPLES_NORMALIZE_LOOP
+    }
+
+    XSAMPLES_TARGET("avx2,fma")
+    static void normalizeAvx2(const Args &args) {
+        XSAMPLES_NORMALIZE_LOOP
+    }
+
+    static void addScaledDefault(const Args &args) {
+        XSAMPLES_ADD_SCALED_LOOP
+    }
+
+    XSAMPLES_TARGET("avx2,fma")
+    static void addScaledAvx2(const Args &args) {
+        XSAMPLES_ADD_SCALED_LOOP
+    }
+
+    static void composeDefault(const Args &args) {
+        XSAMPLES_COMPOSE_LOOP
+    }
+
+    XSAMPLES_TARGET("avx2,fma")
+    static void composeAvx2(const Args &args) {
+        XSAMPLES_COMPOSE_LOOP
+    }
+
+#undef XSAMPLES_FROM_EULER_LOOP
+#undef XSAMPLES_MULTIPLY_LOOP
+#undef XSAMPLES_NORMALIZE_LOOP
+#undef XSAMPLES_ADD_SCALED_LOOP
+#undef XSAMPLES_COMPOSE_LOOP
+};
+
+#endif //XSAMPLES_TRANSFORMSTREAMS_HPP
@@ -0,0 +1,77 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_WORLDTRANSFORM_HPP
+#define XSAMPLES_WORLDTRANSFORM_HPP
+
+#include <algorithm>
+
+#include "ecs/system.hpp"
+
+using namespace xengine;
+
+/**
+ * @param out Column major model matrix of the transform
+ */
+inline void getModelMatrix(const Transform &transform, float out[16]) {
+    auto p = transform.getPosition();
+    auto q = transform.getRotation();
+    auto s = transform.getScale();
+    float x = q.x, y = q.y, z = q.z, w = q.w;
+    float rotation[9] = {
+            1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w),
+            2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+            2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y)
+    };
+    float scale[3] = {s.x, s.y, s.z};
+    for (int c = 0; c < 3; c++) {
+        for (int r = 0; r < 3; r++)
+            out[c * 4 + r] = rotation[c * 3 + r] * scale[c];
+        out[c * 4 + 3] = 0;
+    }
+    out[12] = p.x;
+    out[13] = p.y;
+    out[14] = p.z;
+    out[15] = 1;
+}
+
+/**
+ * @param out Column major model matrix of the entity including the transforms of its parents
+ */
+inline void getWorldMatrix(EntityManager &entityManager, const Entity &entity, float out[16]) {
+    auto &componentManager = entityManager.getComponentManager();
+    auto &component = componentManager.lookup<TransformComponent>(entity);
+    getModelMatrix(component.transform, out);
+    if (component.parent.empty())
+        return;
+
+    float parent[16], local[16];
+    std::copy(out, out + 16, local);
+    getWorldMatrix(entityManager, entityManager.getByName(component.parent), parent);
+    for (int c = 0; c < 4; c++) {
+        for (int r = 0; r < 4; r++) {
+            out[c * 4 + r] = parent[r] * local[c * 4]
+                             + parent[4 + r] * local[c * 4 + 1]
+                             + parent[8 + r] * local[c * 4 + 2]
+                             + parent[12 + r] * local[c * 4 + 3];
+        }
+    }
+}
+
+#endif //XSAMPLES_WORLDTRANSFORM_HPP
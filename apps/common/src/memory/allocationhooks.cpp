@@ -0,0 +1,165 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "memory/allocationtracker.hpp"
+
+#ifdef XSAMPLES_ALLOCATION_TRACKING
+
+#include <cstdlib>
+#include <cstdint>
+
+// Every allocation is prefixed with a header recording its size and tag,
+// so that frees are attributed to the tag which allocated the memory.
+namespace {
+    struct AllocationHeader {
+        size_t size;
+        uint32_t tag;
+        uint32_t offset; // Distance from the start of the malloc block to the user pointer
+    };
+
+    static_assert(sizeof(AllocationHeader) == 16, "Unexpected allocation header size");
+
+    const size_t HEADER_SIZE = 16;
+
+    void *trackedAllocate(size_t size, size_t alignment) {
+        if (alignment < HEADER_SIZE)
+            alignment = HEADER_SIZE;
+
+        // Room for the header in front of the aligned user pointer
+        auto *raw = static_cast<uint8_t *>(std::malloc(size + HEADER_SIZE + alignment - 1));
+        if (raw == nullptr)
+            return nullptr;
+
+        auto address = reinterpret_cast<uintptr_t>(raw) + HEADER_SIZE;
+        address = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        auto *ptr = reinterpret_cast<uint8_t *>(address);
+
+        auto tag = AllocationTracker::getCurrentTag();
+        auto *header = reinterpret_cast<AllocationHeader *>(ptr - HEADER_SIZE);
+        header->size = size;
+        header->tag = tag;
+        header->offset = static_cast<uint32_t>(ptr - raw);
+
+        AllocationTracker::get().onAllocate(tag, size);
+        return ptr;
+    }
+
+    void trackedFree(void *ptr) {
+        if (ptr == nullptr)
+            return;
+        auto *bytes = static_cast<uint8_t *>(ptr);
+        auto *header = reinterpret_cast<AllocationHeader *>(bytes - HEADER_SIZE);
+        AllocationTracker::get().onFree(static_cast<AllocationTag>(header->tag), header->size);
+        std::free(bytes - header->offset);
+    }
+
+    void *allocateOrThrow(size_t size, size_t alignment) {
+        while (true) {
+            auto *ret = trackedAllocate(size, alignment);
+            if (ret != nullptr)
+                return ret;
+            auto handler = std::get_new_handler();
+            if (handler == nullptr)
+                throw std::bad_alloc();
+            handler();
+        }
+    }
+}
+
+void *operator new(size_t size) {
+    return allocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void *operator new[](size_t size) {
+    return allocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return trackedAllocate(size, alignof(std::max_align_t));
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return trackedAllocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return trackedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return trackedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    trackedFree(ptr);
+}
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_ALLOCATIONTRACKER_HPP
+#define XSAMPLES_ALLOCATIONTRACKER_HPP
+
+#include <atomic>
+#include <ostream>
+#include <cstddef>
+
+// Heap usage statistics collected by the global operator new / delete hooks in allocationhooks.cpp.
+// The hooks are only compiled in with -DXSAMPLES_ALLOCATION_TRACKING=ON, otherwise the tracker stays empty.
+// Allocations are attributed to the tag of the calling thread, set with an AllocationScope.
+
+enum AllocationTag {
+    ALLOC_UNTAGGED,
+    ALLOC_ECS,
+    ALLOC_RESOURCES,
+    ALLOC_RENDER,
+    ALLOC_AUDIO,
+    ALLOC_TAG_COUNT
+};
+
+inline const char *getAllocationTagName(AllocationTag tag) {
+    switch (tag) {
+        case ALLOC_UNTAGGED:
+            return "Untagged";
+        case ALLOC_ECS:
+            return "ECS";
+        case ALLOC_RESOURCES:
+            return "Resources";
+        case ALLOC_RENDER:
+            return "Render";
+        case ALLOC_AUDIO:
+            return "Audio";
+        default:
+            return "ERROR";
+    }
+}
+
+class AllocationTracker {
+public:
+    struct TagSnapshot {
+        size_t liveBytes = 0;
+        size_t peakBytes = 0;
+        size_t allocations = 0; // Total number of allocations since startup
+        size_t allocatedBytes = 0; // Total number of bytes allocated since startup
+    };
+
+    struct Snapshot {
+        TagSnapshot tags[ALLOC_TAG_COUNT];
+
+        void write(std::ostream &stream) const {
+            stream << "{\n";
+            for (int i = 0; i < ALLOC_TAG_COUNT; i++) {
+                auto &tag = tags[i];
+                stream << "  \"" << getAllocationTagName(static_cast<AllocationTag>(i)) << "\": {"
+                       << "\"liveBytes\": " << tag.liveBytes
+                       << ", \"peakBytes\": " << tag.peakBytes
+                       << ", \"allocations\": " << tag.allocations
+                       << ", \"allocatedBytes\": " << tag.allocatedBytes
+                       << "}" << (i + 1 < ALLOC_TAG_COUNT ? ",\n" : "\n");
+            }
+            stream << "}\n";
+        }
+    };
+
+    static AllocationTracker &get() {
+        // Constant initialized, usable by allocations during static initialization
+        static AllocationTracker tracker;
+        return tracker;
+    }
+
+    static constexpr bool isEnabled() {
+#ifdef XSAMPLES_ALLOCATION_TRACKING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static AllocationTag getCurrentTag() {
+        return currentTag();
+    }
+
+    static void setCurrentTag(AllocationTag tag) {
+        currentTag() = tag;
+    }
+
+    void onAllocate(AllocationTag tag, size_t size) {
+        auto &stats = tags[tag];
+        auto live = stats.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        stats.allocations.fetch_add(1, std::memory_order_relaxed);
+        stats.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+        auto peak = stats.peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !stats.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    void onFree(AllocationTag tag, size_t size) {
+        tags[tag].liveBytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot ret;
+        for (int i = 0; i < ALLOC_TAG_COUNT; i++) {
+            ret.tags[i].liveBytes = tags[i].liveBytes.load(std::memory_order_relaxed);
+            ret.tags[i].peakBytes = tags[i].peakBytes.load(std::memory_order_relaxed);
+            ret.tags[i].allocations = tags[i].allocations.load(std::memory_order_relaxed);
+            ret.tags[i].allocatedBytes = tags[i].allocatedBytes.load(std::memory_order_relaxed);
+        }
+        return ret;
+    }
+
+private:
+    struct TagStats {
+        std::atomic<size_t> liveBytes{0};
+        std::atomic<size_t> peakBytes{0};
+        std::atomic<size_t> allocations{0};
+        std::atomic<size_t> allocatedBytes{0};
+    };
+
+    static AllocationTag &currentTag() {
+        static thread_local AllocationTag tag = ALLOC_UNTAGGED;
+        return tag;
+    }
+
+    TagStats tags[ALLOC_TAG_COUNT];
+};
+
+// Attributes the allocations of the current thread to tag until the scope is left.
+class AllocationScope {
+public:
+    explicit AllocationScope(AllocationTag tag)
+            : previous(AllocationTracker::getCurrentTag()) {
+        AllocationTracker::setCurrentTag(tag);
+    }
+
+    ~AllocationScope() {
+        AllocationTracker::setCurrentTag(previous);
+    }
+
+    AllocationScope(const AllocationScope &) = delete;
+
+    AllocationScope &operator=(const AllocationScope &) = delete;
+
+private:
+    AllocationTag previous;
+};
+
+#endif //XSAMPLES_ALLOCATIONTRACKER_HPP
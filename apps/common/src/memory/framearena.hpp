@@ -0,0 +1,185 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_FRAMEARENA_HPP
+#define XSAMPLES_FRAMEARENA_HPP
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+
+// Linear allocator for memory which only lives until the end of the current frame.
+// Allocation is a pointer bump, deallocation is a no-op and reset() releases everything at once.
+// When a frame needs more than one block the blocks are merged into a single larger one on reset,
+// so after a few frames the arena serves every frame without touching the heap.
+class FrameArena {
+public:
+    struct Stats {
+        size_t allocations = 0; // Allocations served in the frame
+        size_t bytes = 0; // Bytes handed out in the frame, including alignment padding
+        size_t capacity = 0; // Bytes reserved by the arena
+        size_t heapAllocations = 0; // Blocks allocated from the heap in the frame
+    };
+
+    explicit FrameArena(size_t blockSize = 64 * 1024)
+            : blockSize(blockSize) {}
+
+    FrameArena(const FrameArena &) = delete;
+
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    // The arena of the calling thread, each thread resets its own arena at the end of its frame.
+    static FrameArena &getThreadArena() {
+        static thread_local FrameArena arena;
+        return arena;
+    }
+
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        if (!blocks.empty()) {
+            auto &block = blocks.back();
+            auto ptr = align(block.data.get() + block.offset, alignment);
+            auto end = ptr + size;
+            if (end <= block.data.get() + block.size) {
+                frameStats.bytes += end - (block.data.get() + block.offset);
+                frameStats.allocations++;
+                block.offset = end - block.data.get();
+                return ptr;
+            }
+        }
+
+        // Oversized requests get a dedicated block, the merge on reset accounts for them.
+        auto newSize = std::max(blockSize, size + alignment);
+        addBlock(newSize);
+
+        auto &block = blocks.back();
+        auto ptr = align(block.data.get(), alignment);
+        block.offset = ptr + size - block.data.get();
+        frameStats.bytes += block.offset;
+        frameStats.allocations++;
+        return ptr;
+    }
+
+    template<typename T>
+    T *allocate(size_t count) {
+        return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Releases all allocations of the frame, the memory must not be referenced afterwards.
+    void reset() {
+        lastStats = frameStats;
+        lastStats.capacity = capacity;
+
+        if (blocks.size() > 1) {
+            // Grow to the combined size so the next frame fits into a single block
+            blockSize = capacity;
+            blocks.clear();
+            capacity = 0;
+            addBlock(blockSize);
+            frameStats.heapAllocations = 1;
+        } else {
+            frameStats.heapAllocations = 0;
+        }
+
+        if (!blocks.empty())
+            blocks.back().offset = 0;
+
+        frameStats.allocations = 0;
+        frameStats.bytes = 0;
+    }
+
+    // The statistics of the last completed frame
+    const Stats &getStats() const {
+        return lastStats;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+        size_t offset = 0;
+    };
+
+    static uint8_t *align(uint8_t *ptr, size_t alignment) {
+        auto address = reinterpret_cast<uintptr_t>(ptr);
+        return reinterpret_cast<uint8_t *>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+    }
+
+    void addBlock(size_t size) {
+        Block block;
+        block.data = std::unique_ptr<uint8_t[]>(new uint8_t[size]);
+        block.size = size;
+        blocks.emplace_back(std::move(block));
+        capacity += size;
+        frameStats.heapAllocations++;
+    }
+
+    size_t blockSize;
+    size_t capacity = 0;
+    std::vector<Block> blocks;
+
+    Stats frameStats;
+    Stats lastStats;
+};
+
+// Standard allocator adapter so that containers can be placed in a FrameArena.
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    ArenaAllocator()
+            : arena(&FrameArena::getThreadArena()) {}
+
+    explicit ArenaAllocator(FrameArena &arena)
+            : arena(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) // NOLINT(google-explicit-constructor)
+            : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+        return arena->allocate<T>(n);
+    }
+
+    void deallocate(T *, size_t) {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U> &other) const {
+        return arena == other.arena;
+    }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const {
+        return arena != other.arena;
+    }
+
+private:
+    template<typename U>
+    friend class ArenaAllocator;
+
+    FrameArena *arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif //XSAMPLES_FRAMEARENA_HPP
@@ -0,0 +1,210 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_BLOCKCODEC_HPP
+#define XSAMPLES_BLOCKCODEC_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef XSAMPLES_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef XSAMPLES_WITH_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+#ifdef XSAMPLES_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+// Compression codecs for pak entry blocks, the values are stored in the entry header.
+// Each codec is optional and only compiled in when cmake found the library.
+enum BlockCodec : uint8_t {
+    CODEC_NONE = 0,
+    CODEC_DEFLATE = 1,
+    CODEC_LZ4 = 2,
+    CODEC_ZSTD = 3
+};
+
+inline bool isCodecAvailable(BlockCodec codec) {
+    switch (codec) {
+        case CODEC_NONE:
+            return true;
+#ifdef XSAMPLES_WITH_ZLIB
+        case CODEC_DEFLATE:
+            return true;
+#endif
+#ifdef XSAMPLES_WITH_LZ4
+        case CODEC_LZ4:
+            return true;
+#endif
+#ifdef XSAMPLES_WITH_ZSTD
+        case CODEC_ZSTD:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+inline const char *getCodecName(BlockCodec codec) {
+    switch (codec) {
+        case CODEC_NONE:
+            return "none";
+        case CODEC_DEFLATE:
+            return "deflate";
+        case CODEC_LZ4:
+            return "lz4";
+        case CODEC_ZSTD:
+            return "zstd";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * @return The codec to use for data that is read while the application is running, decode speed over ratio.
+ */
+inline BlockCodec getFastCodec() {
+    if (isCodecAvailable(CODEC_LZ4))
+        return CODEC_LZ4;
+    if (isCodecAvailable(CODEC_ZSTD))
+        return CODEC_ZSTD;
+    return isCodecAvailable(CODEC_DEFLATE) ? CODEC_DEFLATE : CODEC_NONE;
+}
+
+/**
+ * @return The codec to use for data that is rarely read, ratio over decode speed.
+ */
+inline BlockCodec getDenseCodec() {
+    if (isCodecAvailable(CODEC_ZSTD))
+        return CODEC_ZSTD;
+    if (isCodecAvailable(CODEC_DEFLATE))
+        return CODEC_DEFLATE;
+    return isCodecAvailable(CODEC_LZ4) ? CODEC_LZ4 : CODEC_NONE;
+}
+
+/**
+ * The level is interpreted per codec, 0 selects the fast setting and higher values trade speed for ratio.
+ *
+ * @return The compressed size or 0 if the codec failed or the result would not fit into capacity.
+ */
+inline size_t compressBlock(BlockCodec codec,
+                            int level,
+                            const char *src,
+                            size_t size,
+                            char *dst,
+                            size_t capacity) {
+    switch (codec) {
+#ifdef XSAMPLES_WITH_ZLIB
+        case CODEC_DEFLATE: {
+            auto length = static_cast<uLongf>(capacity);
+            auto ret = compress2(reinterpret_cast<Bytef *>(dst),
+                                 &length,
+                                 reinterpret_cast<const Bytef *>(src),
+                                 static_cast<uLong>(size),
+                                 level <= 0 ? Z_BEST_SPEED : std::min(level, Z_BEST_COMPRESSION));
+            return ret == Z_OK ? static_cast<size_t>(length) : 0;
+        }
+#endif
+#ifdef XSAMPLES_WITH_LZ4
+        case CODEC_LZ4: {
+            int ret;
+            if (level <= 0)
+                ret = LZ4_compress_default(src, dst, static_cast<int>(size), static_cast<int>(capacity));
+            else
+                ret = LZ4_compress_HC(src, dst, static_cast<int>(size), static_cast<int>(capacity), level);
+            return ret > 0 ? static_cast<size_t>(ret) : 0;
+        }
+#endif
+#ifdef XSAMPLES_WITH_ZSTD
+        case CODEC_ZSTD: {
+            auto ret = ZSTD_compress(dst, capacity, src, size, level <= 0 ? 1 : level);
+            return ZSTD_isError(ret) ? 0 : ret;
+        }
+#endif
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @return The worst case compressed size of a block of the given size.
+ */
+inline size_t getCompressBound(BlockCodec codec, size_t size) {
+    switch (codec) {
+#ifdef XSAMPLES_WITH_ZLIB
+        case CODEC_DEFLATE:
+            return static_cast<size_t>(compressBound(static_cast<uLong>(size)));
+#endif
+#ifdef XSAMPLES_WITH_LZ4
+        case CODEC_LZ4:
+            return static_cast<size_t>(LZ4_compressBound(static_cast<int>(size)));
+#endif
+#ifdef XSAMPLES_WITH_ZSTD
+        case CODEC_ZSTD:
+            return ZSTD_compressBound(size);
+#endif
+        default:
+            return size;
+    }
+}
+
+/**
+ * @return True if exactly size bytes were decoded into dst.
+ */
+inline bool decompressBlock(BlockCodec codec,
+                            const char *src,
+                            size_t compressedSize,
+                            char *dst,
+                            size_t size) {
+    switch (codec) {
+#ifdef XSAMPLES_WITH_ZLIB
+        case CODEC_DEFLATE: {
+            auto length = static_cast<uLongf>(size);
+            auto ret = uncompress(reinterpret_cast<Bytef *>(dst),
+                                  &length,
+                                  reinterpret_cast<const Bytef *>(src),
+                                  static_cast<uLong>(compressedSize));
+            return ret == Z_OK && length == size;
+        }
+#endif
+#ifdef XSAMPLES_WITH_LZ4
+        case CODEC_LZ4: {
+            auto ret = LZ4_decompress_safe(src, dst, static_cast<int>(compressedSize), static_cast<int>(size));
+            return ret >= 0 && static_cast<size_t>(ret) == size;
+        }
+#endif
+#ifdef XSAMPLES_WITH_ZSTD
+        case CODEC_ZSTD: {
+            auto ret = ZSTD_decompress(dst, size, src, compressedSize);
+            return !ZSTD_isError(ret) && ret == size;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+#endif //XSAMPLES_BLOCKCODEC_HPP
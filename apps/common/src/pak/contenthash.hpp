@@ -0,0 +1,104 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_CONTENTHASH_HPP
+#define XSAMPLES_CONTENTHASH_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/**
+ * 64 bit non cryptographic hash of a buffer (MurmurHash64A), used to find identical payloads.
+ * Callers which have both payloads should still compare the bytes on a match.
+ */
+inline uint64_t contentHash(const char *data, size_t size, uint64_t seed = 0) {
+    const uint64_t m = 0xc6a4a7935bd1e995ull;
+    const int r = 47;
+
+    uint64_t h = seed ^ (size * m);
+
+    auto blocks = size / 8;
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t k;
+        std::memcpy(&k, data + i * 8, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    auto tail = reinterpret_cast<const uint8_t *>(data + blocks * 8);
+    switch (size & 7) {
+        case 7:
+            h ^= static_cast<uint64_t>(tail[6]) << 48;
+            [[fallthrough]];
+        case 6:
+            h ^= static_cast<uint64_t>(tail[5]) << 40;
+            [[fallthrough]];
+        case 5:
+            h ^= static_cast<uint64_t>(tail[4]) << 32;
+            [[fallthrough]];
+        case 4:
+            h ^= static_cast<uint64_t>(tail[3]) << 24;
+            [[fallthrough]];
+        case 3:
+            h ^= static_cast<uint64_t>(tail[2]) << 16;
+            [[fallthrough]];
+        case 2:
+            h ^= static_cast<uint64_t>(tail[1]) << 8;
+            [[fallthrough]];
+        case 1:
+            h ^= static_cast<uint64_t>(tail[0]);
+            h *= m;
+        default:
+            break;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+
+    return h;
+}
+
+/**
+ * @return The hash and size of the payload as a hex string, the size makes accidental collisions even less likely.
+ */
+inline std::string contentKey(const char *data, size_t size) {
+    static const char *digits = "0123456789abcdef";
+
+    auto hash = contentHash(data, size);
+
+    std::string ret(16, '0');
+    for (int i = 15; i >= 0; i--) {
+        ret[i] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+
+    ret += "-";
+    ret += std::to_string(size);
+    return ret;
+}
+
+#endif //XSAMPLES_CONTENTHASH_HPP
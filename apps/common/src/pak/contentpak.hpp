@@ -0,0 +1,202 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_CONTENTPAK_HPP
+#define XSAMPLES_CONTENTPAK_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#include "pak/contenthash.hpp"
+#include "pak/pakmanifest.hpp"
+
+// Groups the entries of a directory into content addressed chunks.
+// Every distinct payload is stored once as an object, the manifest maps the entry paths to the objects.
+//
+// When a previous manifest is passed the build is incremental: objects which already exist in a previous chunk are
+// referenced from there, new payloads are appended as new chunks and the unchanged chunk files do not have to be
+// rewritten or uploaded again. Chunks with too little live data left are compacted into the new chunks.
+class ContentPak {
+public:
+    struct Stats {
+        size_t entries = 0;
+        size_t objects = 0;
+        size_t entryBytes = 0; // Sum of all entry sizes
+        size_t duplicateBytes = 0; // Bytes not stored because an identical payload was already stored
+        size_t reusedObjects = 0; // Objects referenced from previous chunks
+        size_t writtenBytes = 0; // Uncompressed bytes in the chunks to write
+        size_t keptChunks = 0;
+        size_t compactedChunks = 0;
+    };
+
+    struct Result {
+        PakManifest manifest;
+
+        // Chunk index -> object path -> payload, for the chunks which have to be written
+        std::map<int, std::map<std::string, std::vector<char>>> chunks;
+
+        // Chunks of the previous manifest which are not referenced anymore and can be deleted
+        std::set<int> removedChunks;
+
+        Stats stats;
+    };
+
+    /**
+     * @param entries The entries to store, as returned by Pak::readEntries
+     * @param previous The manifest of the previous build or nullptr to write all chunks
+     * @param maxChunkSize The uncompressed size at which a new chunk is started, 0 for a single chunk.
+     * Objects larger than this get their own chunk.
+     * @param compactThreshold Previous chunks with less than this fraction of live bytes are rewritten
+     */
+    static Result build(const std::map<std::string, std::vector<char>> &entries,
+                        const PakManifest *previous = nullptr,
+                        size_t maxChunkSize = 0,
+                        float compactThreshold = 0.5f) {
+        Result ret;
+
+        // Distinct payloads, the first entry path of each is used for the object extension and chunk locality
+        std::map<std::string, std::pair<const std::string *, const std::vector<char> *>> payloads;
+
+        // Keys involved in a hash collision, which payload gets which key depends on the entry order
+        std::set<std::string> collisions;
+
+        for (auto &pair: entries) {
+            auto &data = pair.second;
+            auto baseKey = contentKey(data.data(), data.size());
+            auto key = baseKey;
+
+            // Same hash and size but different bytes, give the payload its own key
+            for (int i = 1;; i++) {
+                auto it = payloads.find(key);
+                if (it == payloads.end() || *it->second.second == data)
+                    break;
+                collisions.insert(key);
+                key = baseKey + "-" + std::to_string(i);
+            }
+
+            if (key != baseKey)
+                collisions.insert(key);
+
+            ret.stats.entries++;
+            ret.stats.entryBytes += data.size();
+
+            if (!payloads.emplace(key, std::make_pair(&pair.first, &data)).second)
+                ret.stats.duplicateBytes += data.size();
+
+            ret.manifest.entries[pair.first] = key;
+        }
+
+        ret.stats.objects = payloads.size();
+
+        // Decide which previous chunks stay, the live bytes are the bytes of objects still referenced.
+        // The total is the recorded chunk size, which still counts the objects dropped by earlier builds.
+        std::map<int, size_t> liveBytes;
+        std::map<int, size_t> totalBytes;
+        int nextChunk = 0;
+        if (previous != nullptr) {
+            std::map<int, size_t> listedBytes;
+            for (auto &pair: previous->objects) {
+                listedBytes[pair.second.chunk] += pair.second.size;
+                if (payloads.find(pair.first) != payloads.end())
+                    liveBytes[pair.second.chunk] += pair.second.size;
+            }
+            totalBytes = previous->chunkSizes;
+            for (auto &pair: listedBytes) {
+                auto &total = totalBytes[pair.first];
+                total = std::max(total, pair.second);
+            }
+            for (auto &pair: totalBytes)
+                nextChunk = std::max(nextChunk, pair.first + 1);
+        }
+
+        std::set<int> keptChunks;
+        for (auto &pair: totalBytes) {
+            auto live = liveBytes[pair.first];
+            if (live > 0 && static_cast<float>(live) >= static_cast<float>(pair.second) * compactThreshold) {
+                keptChunks.insert(pair.first);
+                ret.manifest.chunkSizes[pair.first] = pair.second;
+            } else {
+                ret.removedChunks.insert(pair.first);
+                if (live > 0)
+                    ret.stats.compactedChunks++;
+            }
+        }
+        ret.stats.keptChunks = keptChunks.size();
+
+        // Objects not found in a kept chunk are written, ordered by path so that a directory ends up in few chunks
+        std::vector<std::pair<const std::string *, std::string>> pending;
+        for (auto &pair: payloads) {
+            if (previous != nullptr && collisions.find(pair.first) == collisions.end()) {
+                auto it = previous->objects.find(pair.first);
+                if (it != previous->objects.end() && keptChunks.find(it->second.chunk) != keptChunks.end()) {
+                    ret.manifest.objects[pair.first] = it->second;
+                    ret.stats.reusedObjects++;
+                    continue;
+                }
+            }
+            pending.emplace_back(pair.second.first, pair.first);
+        }
+
+        std::sort(pending.begin(), pending.end(), [](const auto &a, const auto &b) {
+            return *a.first < *b.first;
+        });
+
+        size_t chunkBytes = 0;
+        for (auto &object: pending) {
+            auto &data = *payloads.at(object.second).second;
+
+            if (chunkBytes > 0 && maxChunkSize > 0 && chunkBytes + data.size() > maxChunkSize) {
+                nextChunk++;
+                chunkBytes = 0;
+            }
+
+            PakManifest::Object entry;
+            entry.path = "/objects/" + object.second + getExtension(*object.first);
+            entry.chunk = nextChunk;
+            entry.size = data.size();
+
+            ret.chunks[nextChunk][entry.path] = data;
+            ret.manifest.objects[object.second] = entry;
+            ret.manifest.chunkSizes[nextChunk] += data.size();
+
+            chunkBytes += data.size();
+            ret.stats.writtenBytes += data.size();
+        }
+
+        return ret;
+    }
+
+private:
+    // The extension is kept on the object path so that codec policies by extension still apply to the objects
+    static std::string getExtension(const std::string &path) {
+        auto dot = path.find_last_of('.');
+        if (dot == std::string::npos || path.find('/', dot) != std::string::npos)
+            return "";
+        auto ret = path.substr(dot);
+        if (ret.find_first_of(" \t\r\n") != std::string::npos)
+            return "";
+        return ret;
+    }
+};
+
+#endif //XSAMPLES_CONTENTPAK_HPP
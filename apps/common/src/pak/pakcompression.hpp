@@ -0,0 +1,284 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_PAKCOMPRESSION_HPP
+#define XSAMPLES_PAKCOMPRESSION_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <atomic>
+#include <cctype>
+
+#include "pak/blockcodec.hpp"
+#include "concurrency/threadpool.hpp"
+#include "platform/byteorder.hpp"
+
+// Block framing for compressed pak entries.
+// The entry is split into fixed size blocks which are compressed independently, so that decoding can run
+// on all blocks in parallel and incompressible blocks can be stored raw.
+// Entries without the magic are plain data, paks without compressed entries stay readable as before.
+// Plain data which itself starts with the magic is always framed (with stored blocks if it does not compress),
+// so every entry that starts with the magic is a framed entry.
+//
+// Layout (little endian):
+//  0  char[4]  magic "XSPZ"
+//  4  u8       version
+//  5  u8       codec
+//  6  u16      reserved
+//  8  u32      block size
+//  12 u32      block count
+//  16 u64      uncompressed size
+//  24 u32[]    compressed size of each block, the high bit is set for blocks stored raw
+//  ..          block data
+class PakCompression {
+public:
+    static constexpr size_t HEADER_SIZE = 24;
+    static constexpr uint8_t VERSION = 1;
+    static constexpr uint32_t STORED_FLAG = 0x80000000u;
+
+    struct Options {
+        BlockCodec codec = CODEC_NONE;
+        int level = 0;
+        uint32_t blockSize = 256 * 1024;
+        // Entries smaller than this are stored raw, the header would eat the gain
+        size_t minSize = 512;
+    };
+
+    // Selects a codec per entry path by file extension.
+    struct Policy {
+        Options fast{getFastCodec(), 0};
+        Options dense{getDenseCodec(), 9};
+
+        // Data which is already compressed and would only cost decode time
+        std::set<std::string> storedExtensions{".png", ".jpg", ".jpeg", ".ogg", ".mp3", ".flac", ".zip"};
+
+        // Data which is read once on startup or while loading a scene, size matters more than decode speed
+        std::set<std::string> denseExtensions{".json", ".txt", ".dll", ".ttf", ".glsl", ".hlsl"};
+
+        Options select(const std::string &path) const {
+            auto ext = getExtension(path);
+            if (storedExtensions.find(ext) != storedExtensions.end())
+                return {};
+            if (denseExtensions.find(ext) != denseExtensions.end())
+                return dense;
+            return fast;
+        }
+    };
+
+    struct Stats {
+        size_t entries = 0;
+        size_t compressedEntries = 0;
+        size_t rawBytes = 0;
+        size_t storedBytes = 0;
+    };
+
+    static bool isCompressed(const char *data, size_t size) {
+        return size >= HEADER_SIZE && std::memcmp(data, "XSPZ", 4) == 0;
+    }
+
+    static size_t getUncompressedSize(const char *data, size_t size) {
+        if (!isCompressed(data, size))
+            return size;
+        return static_cast<size_t>(readU64(data + 16));
+    }
+
+    /**
+     * @return The framed entry, or a copy of data if compression did not reduce the size
+     * and data does not start with the magic.
+     */
+    static std::vector<char> encode(const std::vector<char> &data, const Options &options, ThreadPool *pool = nullptr) {
+        auto codec = options.codec;
+        auto frameSize = options.blockSize;
+        bool mustFrame = isCompressed(data.data(), data.size());
+        if (codec == CODEC_NONE
+            || !isCodecAvailable(codec)
+            || data.size() < options.minSize
+            || frameSize == 0
+            || frameSize >= STORED_FLAG) {
+            if (!mustFrame)
+                return data;
+            codec = CODEC_NONE;
+            if (frameSize == 0 || frameSize >= STORED_FLAG)
+                frameSize = Options().blockSize;
+        }
+
+        auto blockSize = static_cast<size_t>(frameSize);
+        auto blockCount = (data.size() + blockSize - 1) / blockSize;
+
+        std::vector<std::vector<char>> blocks(blockCount);
+        std::vector<uint32_t> sizes(blockCount);
+
+        auto compress = [&](size_t i) {
+            auto offset = i * blockSize;
+            auto size = std::min(blockSize, data.size() - offset);
+            auto &block = blocks.at(i);
+            size_t compressedSize = 0;
+            if (codec != CODEC_NONE) {
+                block.resize(getCompressBound(codec, size));
+                compressedSize = compressBlock(codec,
+                                               options.level,
+                                               data.data() + offset,
+                                               size,
+                                               block.data(),
+                                               block.size());
+            }
+            if (compressedSize == 0 || compressedSize >= size) {
+                block.assign(data.begin() + offset, data.begin() + offset + size);
+                sizes.at(i) = static_cast<uint32_t>(size) | STORED_FLAG;
+            } else {
+                block.resize(compressedSize);
+                sizes.at(i) = static_cast<uint32_t>(compressedSize);
+            }
+        };
+
+        if (pool != nullptr) {
+            pool->parallelFor(blockCount, compress);
+        } else {
+            for (size_t i = 0; i < blockCount; i++)
+                compress(i);
+        }
+
+        size_t total = HEADER_SIZE + blockCount * 4;
+        for (auto &block: blocks)
+            total += block.size();
+
+        if (total >= data.size() && !mustFrame)
+            return data;
+
+        std::vector<char> ret(total);
+        auto *ptr = ret.data();
+        std::memcpy(ptr, "XSPZ", 4);
+        ptr[4] = static_cast<char>(VERSION);
+        ptr[5] = static_cast<char>(codec);
+        writeU16(ptr + 6, 0);
+        writeU32(ptr + 8, frameSize);
+        writeU32(ptr + 12, static_cast<uint32_t>(blockCount));
+        writeU64(ptr + 16, data.size());
+        ptr += HEADER_SIZE;
+        for (auto size: sizes) {
+            writeU32(ptr, size);
+            ptr += 4;
+        }
+        for (auto &block: blocks) {
+            std::memcpy(ptr, block.data(), block.size());
+            ptr += block.size();
+        }
+        return ret;
+    }
+
+    /**
+     * Decode a framed entry into output, the blocks are decompressed in parallel on the pool if one is passed.
+     * Data without the magic is copied as is.
+     */
+    static void decode(const char *data, size_t size, std::vector<char> &output, ThreadPool *pool = nullptr) {
+        if (!isCompressed(data, size)) {
+            output.assign(data, data + size);
+            return;
+        }
+
+        auto version = static_cast<uint8_t>(data[4]);
+        auto codec = static_cast<BlockCodec>(data[5]);
+        auto blockSize = static_cast<size_t>(readU32(data + 8));
+        auto blockCount = static_cast<size_t>(readU32(data + 12));
+        auto uncompressedSize = static_cast<size_t>(readU64(data + 16));
+
+        if (version != VERSION)
+            throw std::runtime_error("Unsupported pak entry version " + std::to_string(version));
+        if (!isCodecAvailable(codec))
+            throw std::runtime_error(std::string("Pak entry codec not available: ") + getCodecName(codec));
+        if (blockSize == 0
+            || (uncompressedSize + blockSize - 1) / blockSize != blockCount
+            || HEADER_SIZE + blockCount * 4 > size)
+            throw std::runtime_error("Corrupted pak entry header");
+
+        // Prefix sum of the block table, gives every block its own input range
+        std::vector<size_t> offsets(blockCount + 1);
+        offsets.at(0) = HEADER_SIZE + blockCount * 4;
+        for (size_t i = 0; i < blockCount; i++) {
+            offsets.at(i + 1) = offsets.at(i) + (readU32(data + HEADER_SIZE + i * 4) & ~STORED_FLAG);
+        }
+        if (offsets.back() > size)
+            throw std::runtime_error("Truncated pak entry");
+
+        output.resize(uncompressedSize);
+
+        std::atomic<bool> failed{false};
+        auto decompress = [&](size_t i) {
+            auto stored = (readU32(data + HEADER_SIZE + i * 4) & STORED_FLAG) != 0;
+            auto src = data + offsets.at(i);
+            auto srcSize = offsets.at(i + 1) - offsets.at(i);
+            auto dst = output.data() + i * blockSize;
+            auto dstSize = std::min(blockSize, uncompressedSize - i * blockSize);
+            if (stored) {
+                if (srcSize != dstSize)
+                    failed = true;
+                else
+                    std::memcpy(dst, src, dstSize);
+            } else if (!decompressBlock(codec, src, srcSize, dst, dstSize)) {
+                failed = true;
+            }
+        };
+
+        if (pool != nullptr && blockCount > 1) {
+            pool->parallelFor(blockCount, decompress);
+        } else {
+            for (size_t i = 0; i < blockCount; i++)
+                decompress(i);
+        }
+
+        if (failed)
+            throw std::runtime_error("Failed to decompress pak entry");
+    }
+
+    // Compress the entries in place before they are passed to Pak::createPak.
+    static Stats compressEntries(std::map<std::string, std::vector<char>> &entries,
+                                 const Policy &policy,
+                                 ThreadPool *pool = nullptr) {
+        Stats stats;
+        for (auto &pair: entries) {
+            stats.entries++;
+            stats.rawBytes += pair.second.size();
+            auto encoded = encode(pair.second, policy.select(pair.first), pool);
+            if (isCompressed(encoded.data(), encoded.size())) {
+                if (encoded.size() < pair.second.size())
+                    stats.compressedEntries++;
+                pair.second = std::move(encoded);
+            }
+            stats.storedBytes += pair.second.size();
+        }
+        return stats;
+    }
+
+private:
+    static std::string getExtension(const std::string &path) {
+        auto dot = path.find_last_of('.');
+        if (dot == std::string::npos || path.find('/', dot) != std::string::npos)
+            return "";
+        auto ret = path.substr(dot);
+        for (auto &c: ret)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return ret;
+    }
+};
+
+#endif //XSAMPLES_PAKCOMPRESSION_HPP
@@ -0,0 +1,147 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_PAKMANIFEST_HPP
+#define XSAMPLES_PAKMANIFEST_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+// Maps the entry paths of a content addressed pak set to the stored objects and the objects to their chunk files.
+// Identical payloads share one object, so several paths can reference the same key.
+//
+// Text format, one record per line:
+//  xsamples-pak-manifest 2
+//  chunk <chunk> <size>
+//  object <key> <chunk> <size> <object path>
+//  entry <key> <path>
+//
+// The chunk size includes objects which are no longer referenced but still stored in the chunk file.
+// Version 1 manifests have no chunk records, their chunk sizes are the sums of the listed objects.
+class PakManifest {
+public:
+    struct Object {
+        std::string path; // The path of the object inside the chunk pak
+        int chunk = 0;
+        size_t size = 0; // Uncompressed size
+    };
+
+    static PakManifest read(std::istream &stream) {
+        PakManifest ret;
+
+        std::string line;
+        if (!std::getline(stream, line)
+            || (line != "xsamples-pak-manifest 1" && line != "xsamples-pak-manifest 2"))
+            throw std::runtime_error("Invalid pak manifest header");
+
+        while (std::getline(stream, line)) {
+            if (line.empty())
+                continue;
+
+            std::istringstream ls(line);
+            std::string type;
+            std::string key;
+            ls >> type >> key;
+
+            if (type == "chunk") {
+                size_t size;
+                ls >> size;
+                if (!ls || key.empty() || key.find_first_not_of("0123456789") != std::string::npos)
+                    throw std::runtime_error("Invalid pak manifest chunk: " + line);
+                ret.chunkSizes[std::stoi(key)] = size;
+            } else if (type == "object") {
+                Object object;
+                ls >> object.chunk >> object.size >> object.path;
+                if (!ls)
+                    throw std::runtime_error("Invalid pak manifest object: " + line);
+                ret.objects[key] = object;
+            } else if (type == "entry") {
+                // The path is the rest of the line and may contain spaces
+                auto offset = line.find(key) + key.size() + 1;
+                if (offset > line.size())
+                    throw std::runtime_error("Invalid pak manifest entry: " + line);
+                ret.entries[line.substr(offset)] = key;
+            } else {
+                throw std::runtime_error("Invalid pak manifest record: " + line);
+            }
+        }
+
+        for (auto &pair: ret.entries) {
+            if (ret.objects.find(pair.second) == ret.objects.end())
+                throw std::runtime_error("Pak manifest entry without object: " + pair.first);
+        }
+
+        if (ret.chunkSizes.empty()) {
+            for (auto &pair: ret.objects)
+                ret.chunkSizes[pair.second.chunk] += pair.second.size;
+        }
+
+        return ret;
+    }
+
+    void write(std::ostream &stream) const {
+        stream << "xsamples-pak-manifest 2\n";
+        for (auto &pair: chunkSizes) {
+            stream << "chunk " << pair.first << " " << pair.second << "\n";
+        }
+        for (auto &pair: objects) {
+            stream << "object " << pair.first << " "
+                   << pair.second.chunk << " "
+                   << pair.second.size << " "
+                   << pair.second.path << "\n";
+        }
+        for (auto &pair: entries) {
+            stream << "entry " << pair.second << " " << pair.first << "\n";
+        }
+    }
+
+    bool exists(const std::string &path) const {
+        return entries.find(path) != entries.end();
+    }
+
+    /**
+     * @return The object referenced by path, throws if the path is not in the manifest.
+     */
+    const Object &getObject(const std::string &path) const {
+        return objects.at(entries.at(path));
+    }
+
+    std::set<int> getChunks() const {
+        std::set<int> ret;
+        for (auto &pair: objects)
+            ret.insert(pair.second.chunk);
+        return ret;
+    }
+
+    // Entry path -> object key
+    std::map<std::string, std::string> entries;
+
+    // Object key -> object
+    std::map<std::string, Object> objects;
+
+    // Chunk index -> uncompressed size of all objects stored in the chunk file
+    std::map<int, size_t> chunkSizes;
+};
+
+#endif //XSAMPLES_PAKMANIFEST_HPP
@@ -0,0 +1,60 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_BYTEORDER_HPP
+#define XSAMPLES_BYTEORDER_HPP
+
+#include <cstdint>
+
+// Little endian loads and stores of unaligned integers, used by the binary file formats of the samples
+// so that the files are portable between hosts.
+
+inline uint16_t readU16(const char *ptr) {
+    auto *b = reinterpret_cast<const uint8_t *>(ptr);
+    return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+inline uint32_t readU32(const char *ptr) {
+    auto *b = reinterpret_cast<const uint8_t *>(ptr);
+    return static_cast<uint32_t>(b[0])
+           | (static_cast<uint32_t>(b[1]) << 8)
+           | (static_cast<uint32_t>(b[2]) << 16)
+           | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+inline uint64_t readU64(const char *ptr) {
+    return static_cast<uint64_t>(readU32(ptr)) | (static_cast<uint64_t>(readU32(ptr + 4)) << 32);
+}
+
+inline void writeU16(char *ptr, uint16_t value) {
+    ptr[0] = static_cast<char>(value & 0xFF);
+    ptr[1] = static_cast<char>(value >> 8);
+}
+
+inline void writeU32(char *ptr, uint32_t value) {
+    for (int i = 0; i < 4; i++)
+        ptr[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+}
+
+inline void writeU64(char *ptr, uint64_t value) {
+    writeU32(ptr, static_cast<uint32_t>(value));
+    writeU32(ptr + 4, static_cast<uint32_t>(value >> 32));
+}
+
+#endif //XSAMPLES_BYTEORDER_HPP
@@ -0,0 +1,110 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_CPUFEATURES_HPP
+#define XSAMPLES_CPUFEATURES_HPP
+
+#include <cstdlib>
+#include <string>
+
+// Runtime cpu feature detection for kernels which ship more than one instruction set path.
+// The paths are compiled with per function target attributes so that the binary runs on the baseline
+// architecture of the build (XSAMPLES_ARCH) while still using wider instructions where available.
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define XSAMPLES_X86 1
+#define XSAMPLES_TARGET(x) __attribute__((target(x)))
+#else
+#define XSAMPLES_TARGET(x)
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define XSAMPLES_NEON 1
+#endif
+
+// Placed before a loop whose iterations are independent, the compiler then vectorizes it without runtime alias checks.
+// Pointers may still alias the same element, a vector of elements is loaded before it is stored.
+#if defined(__clang__)
+#define XSAMPLES_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define XSAMPLES_IVDEP _Pragma("GCC ivdep")
+#else
+#define XSAMPLES_IVDEP
+#endif
+
+enum CpuLevel {
+    CPU_SCALAR,
+    CPU_SSE41,
+    CPU_AVX2,
+    CPU_NEON
+};
+
+inline CpuLevel detectCpuLevel() {
+#if defined(XSAMPLES_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return CPU_AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return CPU_SSE41;
+    return CPU_SCALAR;
+#elif defined(XSAMPLES_NEON)
+    return CPU_NEON;
+#else
+    return CPU_SCALAR;
+#endif
+}
+
+// The detected level is cached, the XSAMPLES_CPU environment variable (scalar, sse41, avx2) can lower it for comparisons.
+inline CpuLevel getCpuLevel() {
+    static const CpuLevel level = []() {
+        auto ret = detectCpuLevel();
+        const char *env = std::getenv("XSAMPLES_CPU");
+        if (env != nullptr) {
+            std::string value(env);
+            CpuLevel requested = ret;
+            if (value == "scalar")
+                requested = CPU_SCALAR;
+            else if (value == "sse41")
+                requested = CPU_SSE41;
+            else if (value == "avx2")
+                requested = CPU_AVX2;
+            if (requested < ret)
+                ret = requested;
+        }
+        return ret;
+    }();
+    return level;
+}
+
+inline const char *getCpuLevelName(CpuLevel level) {
+    switch (level) {
+        case CPU_SCALAR:
+            return "Scalar";
+        case CPU_SSE41:
+            return "SSE4.1";
+        case CPU_AVX2:
+            return "AVX2";
+        case CPU_NEON:
+            return "NEON";
+        default:
+            return "ERROR";
+    }
+}
+
+#endif //XSAMPLES_CPUFEATURES_HPP
@@ -0,0 +1,91 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_STARTUPPROFILER_HPP
+#define XSAMPLES_STARTUPPROFILER_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <ostream>
+
+// Splits the startup into consecutive named phases, from the start of the application until the first frame
+// was presented. Beginning a phase ends the previous one.
+class StartupProfiler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Phase {
+        std::string name;
+        float time = 0; // Milliseconds
+    };
+
+    StartupProfiler()
+            : startTime(Clock::now()), phaseStart(startTime) {}
+
+    void begin(const std::string &name) {
+        end();
+        current = name;
+        active = true;
+    }
+
+    void end() {
+        auto now = Clock::now();
+        if (active) {
+            phases.push_back({current, std::chrono::duration<float, std::milli>(now - phaseStart).count()});
+            total = std::chrono::duration<float, std::milli>(now - startTime).count();
+        }
+        phaseStart = now;
+        active = false;
+    }
+
+    bool isActive() const {
+        return active;
+    }
+
+    const std::vector<Phase> &getPhases() const {
+        return phases;
+    }
+
+    /**
+     * @return The time from construction until the end of the last phase in milliseconds.
+     */
+    float getTotal() const {
+        return total;
+    }
+
+    void writeReport(std::ostream &stream) const {
+        stream << "{\n  \"phases\": [";
+        for (size_t i = 0; i < phases.size(); i++) {
+            stream << (i == 0 ? "\n" : ",\n")
+                   << "    {\"name\": \"" << phases[i].name << "\", \"ms\": " << phases[i].time << "}";
+        }
+        stream << "\n  ],\n  \"totalMs\": " << total << "\n}\n";
+    }
+
+private:
+    Clock::time_point startTime;
+    Clock::time_point phaseStart;
+    std::string current;
+    bool active = false;
+    std::vector<Phase> phases;
+    float total = 0;
+};
+
+#endif //XSAMPLES_STARTUPPROFILER_HPP
@@ -0,0 +1,135 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_FRAMEGRAPHPLANNER_HPP
+#define XSAMPLES_FRAMEGRAPHPLANNER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <stdexcept>
+
+// Compiles a description of the passes of a FrameGraphPipeline and the transient render targets they exchange.
+// Passes which are disabled or whose outputs are not consumed on the way to the final output are culled,
+// and the memory of the transient targets of the remaining passes is estimated from their pixel formats.
+class FrameGraphPlanner {
+public:
+    struct Resource {
+        int bytesPerPixel = 4;
+        bool multisampled = false;
+    };
+
+    struct Pass {
+        std::string name;
+        std::vector<std::string> inputs; // Inputs without an enabled producer are treated as absent
+        std::vector<std::string> outputs;
+        bool enabled = true;
+    };
+
+    struct Plan {
+        std::vector<size_t> passes; // Indices of the passes to execute, in order
+        size_t targetBytes = 0; // Memory of the transient targets
+
+        bool operator==(const Plan &other) const {
+            return passes == other.passes && targetBytes == other.targetBytes;
+        }
+
+        bool operator!=(const Plan &other) const {
+            return !(*this == other);
+        }
+    };
+
+    void addResource(const std::string &name, int bytesPerPixel, bool multisampled) {
+        resources[name] = {bytesPerPixel, multisampled};
+    }
+
+    void addPass(const std::string &name,
+                 const std::vector<std::string> &inputs,
+                 const std::vector<std::string> &outputs) {
+        passes.emplace_back(Pass{name, inputs, outputs, true});
+    }
+
+    void setPassEnabled(const std::string &name, bool enabled) {
+        for (auto &pass: passes) {
+            if (pass.name == name) {
+                pass.enabled = enabled;
+                return;
+            }
+        }
+        throw std::runtime_error("Unknown pass " + name);
+    }
+
+    const std::vector<Pass> &getPasses() const {
+        return passes;
+    }
+
+    /**
+     * @param output The resource which is presented, it is not transient and not counted.
+     */
+    Plan compile(const std::string &output, int width, int height, int samples) const {
+        Plan ret;
+
+        // Walk backwards from the output and keep every enabled pass which produces a needed resource
+        std::vector<bool> keep(passes.size(), false);
+        std::vector<std::string> needed = {output};
+        for (size_t i = passes.size(); i-- > 0;) {
+            auto &pass = passes.at(i);
+            if (!pass.enabled)
+                continue;
+            for (auto &out: pass.outputs) {
+                if (std::find(needed.begin(), needed.end(), out) != needed.end()) {
+                    keep.at(i) = true;
+                    break;
+                }
+            }
+            if (keep.at(i))
+                needed.insert(needed.end(), pass.inputs.begin(), pass.inputs.end());
+        }
+
+        for (size_t i = 0; i < passes.size(); i++) {
+            if (keep.at(i))
+                ret.passes.emplace_back(i);
+        }
+
+        // Every transient target written by an executed pass has its own allocation
+        std::set<std::string> targets;
+        for (auto index: ret.passes) {
+            for (auto &out: passes.at(index).outputs) {
+                if (out == output || !targets.insert(out).second)
+                    continue;
+                auto it = resources.find(out);
+                if (it == resources.end())
+                    throw std::runtime_error("Unknown resource " + out);
+                ret.targetBytes += static_cast<size_t>(width) * static_cast<size_t>(height)
+                                   * static_cast<size_t>(it->second.bytesPerPixel)
+                                   * static_cast<size_t>(it->second.multisampled ? samples : 1);
+            }
+        }
+
+        return ret;
+    }
+
+private:
+    std::map<std::string, Resource> resources;
+    std::vector<Pass> passes;
+};
+
+#endif //XSAMPLES_FRAMEGRAPHPLANNER_HPP
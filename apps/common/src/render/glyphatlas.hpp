@@ -0,0 +1,167 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_GLYPHATLAS_HPP
+#define XSAMPLES_GLYPHATLAS_HPP
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+// Slot allocation for a glyph texture atlas divided into fixed size cells.
+// Each cached glyph occupies one cell, when the atlas is full the least recently used glyph is evicted.
+// Glyphs used in the current frame are never evicted, their cells may still be referenced by queued quads.
+class GlyphAtlas {
+public:
+    struct Cell {
+        int x; // Pixel origin of the cell inside the atlas
+        int y;
+    };
+
+    struct Stats {
+        unsigned long hits = 0;
+        unsigned long misses = 0;
+        unsigned long evictions = 0;
+        unsigned long failures = 0; // Lookups which found no cell because all cells are used by the current frame
+        size_t resident = 0;
+        size_t capacity = 0;
+    };
+
+    GlyphAtlas(int width = 512, int height = 512, int cellSize = 64)
+            : width(width),
+              height(height),
+              cellSize(cellSize),
+              columns(static_cast<size_t>(width / getValidCellSize(width, height, cellSize))),
+              entries(static_cast<size_t>((width / cellSize) * (height / cellSize))) {
+        for (size_t i = entries.size(); i > 0; i--)
+            freeCells.emplace_back(i - 1);
+        stats.capacity = entries.size();
+    }
+
+    static uint64_t getKey(uint32_t codepoint, int pixelSize) {
+        return (static_cast<uint64_t>(pixelSize) << 32) | codepoint;
+    }
+
+    /**
+     * Look up the cell of a glyph, allocating or evicting a cell on a miss.
+     *
+     * @param rasterize Set to true if the cell was newly assigned and the glyph has to be written into it
+     * @return False if the glyph is not cached and no cell can be freed in this frame
+     */
+    bool acquire(uint64_t key, Cell &cell, bool &rasterize) {
+        auto it = cells.find(key);
+        if (it != cells.end()) {
+            auto &entry = entries[it->second];
+            lru.splice(lru.begin(), lru, entry.position);
+            entry.frame = frame;
+            cell = getCell(it->second);
+            rasterize = false;
+            stats.hits++;
+            return true;
+        }
+
+        size_t index;
+        if (!freeCells.empty()) {
+            index = freeCells.back();
+            freeCells.pop_back();
+            lru.emplace_front(index);
+        } else {
+            index = lru.back();
+            auto &victim = entries[index];
+            if (victim.frame == frame) {
+                stats.failures++;
+                return false;
+            }
+            cells.erase(victim.key);
+            lru.splice(lru.begin(), lru, victim.position);
+            stats.evictions++;
+        }
+
+        auto &entry = entries[index];
+        entry.key = key;
+        entry.frame = frame;
+        entry.position = lru.begin();
+        cells[key] = index;
+
+        cell = getCell(index);
+        rasterize = true;
+        stats.misses++;
+        return true;
+    }
+
+    // Glyphs acquired before this call become candidates for eviction.
+    void nextFrame() {
+        frame++;
+    }
+
+    int getWidth() const {
+        return width;
+    }
+
+    int getHeight() const {
+        return height;
+    }
+
+    int getCellSize() const {
+        return cellSize;
+    }
+
+    Stats getStats() const {
+        auto ret = stats;
+        ret.resident = cells.size();
+        return ret;
+    }
+
+private:
+    struct Entry {
+        uint64_t key = 0;
+        unsigned long frame = 0;
+        std::list<size_t>::iterator position;
+    };
+
+    // The atlas needs at least one cell, otherwise there is nothing to evict on a miss
+    static int getValidCellSize(int width, int height, int cellSize) {
+        if (cellSize <= 0 || cellSize > width || cellSize > height)
+            throw std::runtime_error("Glyph atlas cell size does not fit the atlas");
+        return cellSize;
+    }
+
+    Cell getCell(size_t index) const {
+        return {static_cast<int>(index % columns) * cellSize, static_cast<int>(index / columns) * cellSize};
+    }
+
+    int width;
+    int height;
+    int cellSize;
+    size_t columns;
+
+    std::vector<Entry> entries;
+    std::vector<size_t> freeCells;
+    std::list<size_t> lru; // Occupied cells, most recently used first
+    std::unordered_map<uint64_t, size_t> cells;
+
+    unsigned long frame = 1;
+
+    Stats stats;
+};
+
+#endif //XSAMPLES_GLYPHATLAS_HPP
@@ -0,0 +1,304 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_LIGHTCLUSTERS_HPP
+#define XSAMPLES_LIGHTCLUSTERS_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "platform/cpufeatures.hpp"
+
+// Bins spherical light volumes into a grid of view space clusters (screen tiles x exponential depth slices).
+// The shading of a fragment then only has to consider the lights of its cluster instead of every light in the scene.
+// Lights are stored as structure of arrays so that the view space transform vectorizes,
+// the per slice binning runs in parallel when OpenMP is enabled.
+class LightClusterGrid {
+public:
+    struct View {
+        float position[3];
+        float right[3];
+        float up[3];
+        float forward[3]; // Viewing direction
+        float fovY; // Degrees
+        float aspectRatio;
+        float nearClip;
+        float farClip;
+    };
+
+    struct Stats {
+        size_t lights = 0;
+        size_t visibleLights = 0; // Lights overlapping at least one cluster
+        size_t indices = 0; // Total light references over all clusters
+        size_t occupiedClusters = 0;
+        size_t maxLightsPerCluster = 0;
+    };
+
+    LightClusterGrid(int tilesX = 16, int tilesY = 9, int slices = 24)
+            : tilesX(tilesX),
+              tilesY(tilesY),
+              slices(slices),
+              offsets(static_cast<size_t>(tilesX * tilesY * slices) + 1),
+              sliceIndices(static_cast<size_t>(slices)),
+              sliceCounts(static_cast<size_t>(slices)),
+              sliceCursors(static_cast<size_t>(slices)) {}
+
+    void clearLights() {
+        lx.clear();
+        ly.clear();
+        lz.clear();
+        lr.clear();
+    }
+
+    void addLight(float x, float y, float z, float radius) {
+        lx.emplace_back(x);
+        ly.emplace_back(y);
+        lz.emplace_back(z);
+        lr.emplace_back(radius);
+    }
+
+    // The distance at which a light with the given attenuation falls below threshold of its intensity.
+    static float getLightRadius(float constant, float linear, float quadratic, float intensity, float threshold = 1.0f / 256.0f) {
+        float c = constant - intensity / threshold;
+        if (c >= 0)
+            return 0; // Below the threshold even at the light position
+        if (quadratic <= 0) {
+            if (linear <= 0)
+                return 1e30f;
+            return -c / linear;
+        }
+        return (-linear + std::sqrt(linear * linear - 4 * quadratic * c)) / (2 * quadratic);
+    }
+
+    void build(const View &view) {
+        auto count = lx.size();
+        vx.resize(count);
+        vy.resize(count);
+        vz.resize(count);
+        ranges.resize(count);
+
+        if (getCpuLevel() == CPU_AVX2)
+            transformAvx2(view, count);
+        else
+            transformDefault(view, count);
+
+        tanHalfY = std::tan(view.fovY * 0.5f * 3.14159265f / 180.0f);
+        tanHalfX = tanHalfY * view.aspectRatio;
+        nearClip = view.nearClip;
+        farClip = view.farClip;
+        logDepthScale = static_cast<float>(slices) / std::log(view.farClip / view.nearClip);
+
+        for (size_t i = 0; i < count; i++)
+            ranges[i] = computeRange(vx[i], vy[i], vz[i], lr[i]);
+
+        // Each slice is binned independently into its own index list
+#pragma omp parallel for schedule(dynamic)
+        for (int z = 0; z < slices; z++)
+            binSlice(z);
+
+        // Concatenate the slices into the global offset / index arrays
+        indices.clear();
+        size_t cluster = 0;
+        stats = {};
+        stats.lights = count;
+        for (int z = 0; z < slices; z++) {
+            auto &counts = sliceCounts[z];
+            size_t sliceBase = indices.size();
+            size_t local = 0;
+            for (auto c: counts) {
+                offsets[cluster++] = sliceBase + local;
+                local += c;
+                if (c > 0)
+                    stats.occupiedClusters++;
+                stats.maxLightsPerCluster = std::max<size_t>(stats.maxLightsPerCluster, c);
+            }
+            indices.insert(indices.end(), sliceIndices[z].begin(), sliceIndices[z].end());
+        }
+        offsets[cluster] = indices.size();
+        stats.indices = indices.size();
+
+        for (auto &range: ranges) {
+            if (range.valid)
+                stats.visibleLights++;
+        }
+    }
+
+    int getClusterIndex(int tileX, int tileY, int slice) const {
+        return (slice * tilesY + tileY) * tilesX + tileX;
+    }
+
+    // The lights of a cluster are indices[offsets[cluster]] to indices[offsets[cluster + 1]]
+    const std::vector<size_t> &getOffsets() const {
+        return offsets;
+    }
+
+    const std::vector<uint32_t> &getIndices() const {
+        return indices;
+    }
+
+    size_t getClusterCount() const {
+        return offsets.size() - 1;
+    }
+
+    const Stats &getStats() const {
+        return stats;
+    }
+
+private:
+    struct Range {
+        bool valid;
+        int16_t x0, x1, y0, y1, z0, z1;
+    };
+
+    // Same loop compiled twice, the target attribute lets the compiler vectorize it with avx2.
+#define XSAMPLES_LIGHT_TRANSFORM_LOOP                                                                   \
+        for (size_t i = 0; i < count; i++) {                                                            \
+            float dx = lx[i] - view.position[0];                                                        \
+            float dy = ly[i] - view.position[1];                                                        \
+            float dz = lz[i] - view.position[2];                                                        \
+            vx[i] = dx * view.right[0] + dy * view.right[1] + dz * view.right[2];                       \
+            vy[i] = dx * view.up[0] + dy * view.up[1] + dz * view.up[2];                                \
+            vz[i] = dx * view.forward[0] + dy * view.forward[1] + dz * view.forward[2];                 \
+        }
+
+    void transformDefault(const View &view, size_t count) {
+        XSAMPLES_LIGHT_TRANSFORM_LOOP
+    }
+
+    XSAMPLES_TARGET("avx2,fma")
+    void transformAvx2(const View &view, size_t count) {
+        XSAMPLES_LIGHT_TRANSFORM_LOOP
+    }
+
+#undef XSAMPLES_LIGHT_TRANSFORM_LOOP
+
+    int getSlice(float depth) const {
+        if (depth <= nearClip)
+            return 0;
+        return std::min(slices - 1, static_cast<int>(std::log(depth / nearClip) * logDepthScale));
+    }
+
+    static int toTile(float ndc, int tiles) {
+        auto t = static_cast<int>(std::floor((ndc * 0.5f + 0.5f) * static_cast<float>(tiles)));
+        return std::max(0, std::min(tiles - 1, t));
+    }
+
+    // Conservative tile and slice range of a sphere in view space
+    Range computeRange(float x, float y, float z, float r) const {
+        Range ret{};
+        float zMin = z - r;
+        float zMax = z + r;
+        if (zMax < nearClip || zMin > farClip) {
+            ret.valid = false;
+            return ret;
+        }
+
+        ret.valid = true;
+        ret.z0 = static_cast<int16_t>(getSlice(zMin));
+        ret.z1 = static_cast<int16_t>(getSlice(zMax));
+
+        if (zMin <= nearClip) {
+            // The sphere touches the near plane, its projection is unbounded
+            ret.x0 = 0;
+            ret.x1 = static_cast<int16_t>(tilesX - 1);
+            ret.y0 = 0;
+            ret.y1 = static_cast<int16_t>(tilesY - 1);
+            return ret;
+        }
+
+        // (x -+ r) / z is monotonic in z, evaluating it at both depth extremes bounds the projection
+        float xMin = std::min((x - r) / zMin, (x - r) / zMax) / tanHalfX;
+        float xMax = std::max((x + r) / zMin, (x + r) / zMax) / tanHalfX;
+        float yMin = std::min((y - r) / zMin, (y - r) / zMax) / tanHalfY;
+        float yMax = std::max((y + r) / zMin, (y + r) / zMax) / tanHalfY;
+
+        if (xMax < -1 || xMin > 1 || yMax < -1 || yMin > 1) {
+            ret.valid = false;
+            return ret;
+        }
+
+        ret.x0 = static_cast<int16_t>(toTile(xMin, tilesX));
+        ret.x1 = static_cast<int16_t>(toTile(xMax, tilesX));
+        ret.y0 = static_cast<int16_t>(toTile(yMin, tilesY));
+        ret.y1 = static_cast<int16_t>(toTile(yMax, tilesY));
+        return ret;
+    }
+
+    void binSlice(int z) {
+        auto &counts = sliceCounts[z];
+        auto &out = sliceIndices[z];
+        counts.assign(static_cast<size_t>(tilesX * tilesY), 0);
+
+        for (auto &range: ranges) {
+            if (!range.valid || z < range.z0 || z > range.z1)
+                continue;
+            for (int y = range.y0; y <= range.y1; y++) {
+                for (int x = range.x0; x <= range.x1; x++)
+                    counts[y * tilesX + x]++;
+            }
+        }
+
+        // Prefix sum to the start of each tile inside the slice list, then fill
+        auto &tileCursor = sliceCursors[z];
+        tileCursor.resize(counts.size());
+        uint32_t total = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            tileCursor[i] = total;
+            total += counts[i];
+        }
+        out.resize(total);
+
+        for (size_t l = 0; l < ranges.size(); l++) {
+            auto &range = ranges[l];
+            if (!range.valid || z < range.z0 || z > range.z1)
+                continue;
+            for (int y = range.y0; y <= range.y1; y++) {
+                for (int x = range.x0; x <= range.x1; x++)
+                    out[tileCursor[y * tilesX + x]++] = static_cast<uint32_t>(l);
+            }
+        }
+    }
+
+    int tilesX;
+    int tilesY;
+    int slices;
+
+    float tanHalfX = 1;
+    float tanHalfY = 1;
+    float nearClip = 0.1f;
+    float farClip = 1000;
+    float logDepthScale = 1;
+
+    std::vector<float> lx, ly, lz, lr; // World space light spheres
+    std::vector<float> vx, vy, vz; // View space centers
+    std::vector<Range> ranges;
+
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> indices;
+
+    std::vector<std::vector<uint32_t>> sliceIndices;
+    std::vector<std::vector<uint32_t>> sliceCounts;
+    std::vector<std::vector<uint32_t>> sliceCursors;
+
+    Stats stats;
+};
+
+#endif //XSAMPLES_LIGHTCLUSTERS_HPP
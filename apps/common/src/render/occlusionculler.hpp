@@ -0,0 +1,297 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_OCCLUSIONCULLER_HPP
+#define XSAMPLES_OCCLUSIONCULLER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+#include "render/softrasterizer.hpp"
+#include "platform/cpufeatures.hpp"
+
+// Conservative occlusion test against a low resolution depth buffer of selected occluder meshes.
+// The occluders are rasterized depth only by the SoftRasterizer, the buffer is then reduced to the farthest
+// view distance per block. An object is occluded when its nearest bounding box corner is behind that distance
+// in every block its projected bounds touch.
+// Occluders have to be solid, alpha tested geometry like foliage would hide objects visible through its holes.
+class OcclusionCuller {
+public:
+    static const int BLOCK_SIZE = 8;
+
+    typedef SoftRasterizer::Vertex Vertex;
+    typedef SoftRasterizer::View View;
+
+    struct Stats {
+        size_t occluders = 0;
+        size_t occluderTriangles = 0;
+        size_t tested = 0;
+        size_t occluded = 0;
+        float rasterTime = 0; // Milliseconds
+        float testTime = 0; // Spent in testObjects
+    };
+
+    explicit OcclusionCuller(int width = 256, int height = 144)
+            : rasterizer(width, height),
+              blocksX((width + BLOCK_SIZE - 1) / BLOCK_SIZE),
+              blocksY((height + BLOCK_SIZE - 1) / BLOCK_SIZE),
+              blockDistance(static_cast<size_t>(blocksX * blocksY)) {
+        rasterizer.setShading(false);
+        rasterizer.setCullBackFaces(true);
+        avx2 = getCpuLevel() == CPU_AVX2;
+    }
+
+    // Start a new frame, drops the occluders of the previous frame.
+    void begin(const View &value) {
+        view = value;
+        rasterizer.clearDraws();
+        rasterizer.setView(view);
+        rasterizer.getViewProjection(viewProjection);
+        material = rasterizer.addMaterial({});
+        stats = {};
+    }
+
+    /**
+     * The vertex and index data is referenced until render() returned.
+     *
+     * @param model Column major model matrix
+     */
+    void addOccluder(const Vertex *vertices,
+                     size_t vertexCount,
+                     const uint32_t *indices,
+                     size_t indexCount,
+                     const float model[16]) {
+        rasterizer.draw(vertices, vertexCount, indices, indexCount, model, material);
+        stats.occluders++;
+        stats.occluderTriangles += indexCount / 3;
+    }
+
+    // Rasterize the occluders and build the block distances.
+    void render() {
+        auto start = std::chrono::steady_clock::now();
+
+        rasterizer.render();
+
+        // Window depth back to view distance, so that the test can use a bias relative to the distance
+        float n = view.nearClip;
+        float f = view.farClip;
+        float a = 2 * f * n;
+        float b = f + n;
+        float c = f - n;
+
+        auto &depth = rasterizer.getDepth();
+        auto width = rasterizer.getWidth();
+        auto height = rasterizer.getHeight();
+        for (int by = 0; by < blocksY; by++) {
+            for (int bx = 0; bx < blocksX; bx++) {
+                int x0 = bx * BLOCK_SIZE;
+                int x1 = std::min(width, x0 + BLOCK_SIZE);
+                int y0 = by * BLOCK_SIZE;
+                int y1 = std::min(height, y0 + BLOCK_SIZE);
+                float farthest = avx2
+                                 ? maxDepthAvx2(depth.data(), width, x0, x1, y0, y1)
+                                 : maxDepthDefault(depth.data(), width, x0, x1, y0, y1);
+                // Uncovered pixels keep the cleared depth of 1 and never occlude anything
+                blockDistance[by * blocksX + bx] = farthest >= 1.0f
+                                                   ? INFINITY
+                                                   : a / (b - (farthest * 2 - 1) * c);
+            }
+        }
+
+        stats.rasterTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * Test an object bounding box against the occluders rendered this frame.
+     * Objects intersecting the near plane or outside of the view are never reported as occluded,
+     * frustum culling is left to the renderer.
+     *
+     * @param boundsMin The minimum corner of the bounding box in model space
+     * @param boundsMax The maximum corner of the bounding box in model space
+     * @param model Column major model matrix
+     */
+    bool isOccluded(const float boundsMin[3], const float boundsMax[3], const float model[16]) {
+        auto ret = testBounds(boundsMin, boundsMax, model);
+        stats.tested++;
+        if (ret)
+            stats.occluded++;
+        return ret;
+    }
+
+    struct Object {
+        float boundsMin[3];
+        float boundsMax[3];
+        float model[16];
+    };
+
+    /**
+     * Test count objects, occluded receives 1 for each occluded object.
+     *
+     * @return The number of occluded objects
+     */
+    size_t testObjects(const Object *objects, size_t count, uint8_t *occluded) {
+        auto start = std::chrono::steady_clock::now();
+        size_t ret = 0;
+        for (size_t i = 0; i < count; i++) {
+            occluded[i] = testBounds(objects[i].boundsMin, objects[i].boundsMax, objects[i].model) ? 1 : 0;
+            ret += occluded[i];
+        }
+        stats.tested += count;
+        stats.occluded += ret;
+        stats.testTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return ret;
+    }
+
+    const Stats &getStats() const {
+        return stats;
+    }
+
+    const SoftRasterizer &getRasterizer() const {
+        return rasterizer;
+    }
+
+private:
+    // Objects are only culled if they are behind the occluders by this fraction of their distance
+    static constexpr float DISTANCE_BIAS = 0.01f;
+
+    // Same loops compiled twice, the target attribute lets the compiler vectorize them with avx2.
+#define XSAMPLES_OCCLUSION_MAX_DEPTH_LOOP                                                               \
+        float ret = 0;                                                                                  \
+        for (int y = y0; y < y1; y++) {                                                                 \
+            const float *row = depth + y * width;                                                       \
+            for (int x = x0; x < x1; x++)                                                               \
+                ret = row[x] > ret ? row[x] : ret;                                                      \
+        }                                                                                               \
+        return ret;
+
+#define XSAMPLES_OCCLUSION_CORNER_LOOP                                                                  \
+        for (int i = 0; i < 8; i++) {                                                                   \
+            float x = (i & 1) ? boundsMax[0] : boundsMin[0];                                            \
+            float y = (i & 2) ? boundsMax[1] : boundsMin[1];                                            \
+            float z = (i & 4) ? boundsMax[2] : boundsMin[2];                                            \
+            cx[i] = mvp[0] * x + mvp[4] * y + mvp[8] * z + mvp[12];                                     \
+            cy[i] = mvp[1] * x + mvp[5] * y + mvp[9] * z + mvp[13];                                     \
+            cw[i] = mvp[3] * x + mvp[7] * y + mvp[11] * z + mvp[15];                                    \
+        }
+
+    static float maxDepthDefault(const float *depth, int width, int x0, int x1, int y0, int y1) {
+        XSAMPLES_OCCLUSION_MAX_DEPTH_LOOP
+    }
+
+    XSAMPLES_TARGET("avx2,fma")
+    static float maxDepthAvx2(const float *depth, int width, int x0, int x1, int y0, int y1) {
+        XSAMPLES_OCCLUSION_MAX_DEPTH_LOOP
+    }
+
+    static void transformCornersDefault(const float mvp[16],
+                                        const float boundsMin[3],
+                                        const float boundsMax[3],
+                                        float cx[8], float cy[8], float cw[8]) {
+        XSAMPLES_OCCLUSION_CORNER_LOOP
+    }
+
+    XSAMPLES_TARGET("avx2,fma")
+    static void transformCornersAvx2(const float mvp[16],
+                                     const float boundsMin[3],
+                                     const float boundsMax[3],
+                                     float cx[8], float cy[8], float cw[8]) {
+        XSAMPLES_OCCLUSION_CORNER_LOOP
+    }
+
+#undef XSAMPLES_OCCLUSION_MAX_DEPTH_LOOP
+#undef XSAMPLES_OCCLUSION_CORNER_LOOP
+
+    bool testBounds(const float boundsMin[3], const float boundsMax[3], const float model[16]) const {
+        float mvp[16];
+        for (int c = 0; c < 4; c++) {
+            for (int r = 0; r < 4; r++) {
+                mvp[c * 4 + r] = viewProjection[r] * model[c * 4]
+                                 + viewProjection[4 + r] * model[c * 4 + 1]
+                                 + viewProjection[8 + r] * model[c * 4 + 2]
+                                 + viewProjection[12 + r] * model[c * 4 + 3];
+            }
+        }
+
+        float cx[8], cy[8], cw[8];
+        if (avx2)
+            transformCornersAvx2(mvp, boundsMin, boundsMax, cx, cy, cw);
+        else
+            transformCornersDefault(mvp, boundsMin, boundsMax, cx, cy, cw);
+
+        // Clip space w is the view distance of the corner
+        float nearest = INFINITY;
+        float minX = INFINITY, maxX = -INFINITY, minY = INFINITY, maxY = -INFINITY;
+        for (int i = 0; i < 8; i++) {
+            if (cw[i] <= view.nearClip)
+                return false;
+            float invW = 1.0f / cw[i];
+            float sx = cx[i] * invW;
+            float sy = cy[i] * invW;
+            minX = std::min(minX, sx);
+            maxX = std::max(maxX, sx);
+            minY = std::min(minY, sy);
+            maxY = std::max(maxY, sy);
+            nearest = std::min(nearest, cw[i]);
+        }
+
+        auto width = static_cast<float>(rasterizer.getWidth());
+        auto height = static_cast<float>(rasterizer.getHeight());
+
+        // Normalized device coordinates to pixels, y points down as in the rasterizer
+        float px0 = (minX * 0.5f + 0.5f) * width;
+        float px1 = (maxX * 0.5f + 0.5f) * width;
+        float py0 = (0.5f - maxY * 0.5f) * height;
+        float py1 = (0.5f - minY * 0.5f) * height;
+        if (px1 < 0 || py1 < 0 || px0 >= width || py0 >= height)
+            return false;
+
+        int bx0 = std::max(0, static_cast<int>(std::floor(px0)) / BLOCK_SIZE);
+        int bx1 = std::min(blocksX - 1, static_cast<int>(std::floor(px1)) / BLOCK_SIZE);
+        int by0 = std::max(0, static_cast<int>(std::floor(py0)) / BLOCK_SIZE);
+        int by1 = std::min(blocksY - 1, static_cast<int>(std::floor(py1)) / BLOCK_SIZE);
+
+        float threshold = nearest * (1.0f - DISTANCE_BIAS);
+        for (int by = by0; by <= by1; by++) {
+            const float *row = blockDistance.data() + by * blocksX;
+            bool visible = false;
+            for (int bx = bx0; bx <= bx1; bx++)
+                visible |= row[bx] >= threshold;
+            if (visible)
+                return false;
+        }
+        return true;
+    }
+
+    SoftRasterizer rasterizer;
+    int blocksX;
+    int blocksY;
+    std::vector<float> blockDistance;
+    bool avx2 = false;
+
+    View view{};
+    float viewProjection[16]{};
+    uint32_t material = 0;
+
+    Stats stats;
+};
+
+#endif //XSAMPLES_OCCLUSIONCULLER_HPP
@@ -0,0 +1,777 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_SOFTRASTERIZER_HPP
+#define XSAMPLES_SOFTRASTERIZER_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+
+#include "platform/cpufeatures.hpp"
+
+// Tile binned software rasterizer for rendering without a gpu.
+// Triangles are set up and binned into screen tiles, each tile then resolves visibility with a depth test
+// into a tile local visibility buffer and shades every covered pixel once with the phong model of the
+// forward renderer. Pixels without geometry receive the clear color, which is what the composite pass does.
+// Vertex transform, triangle setup and tiles run in parallel when OpenMP is enabled.
+// The output only depends on the submitted draws, not on the number of threads.
+class SoftRasterizer {
+public:
+    static constexpr int TILE_SIZE = 32;
+
+    struct Vertex {
+        float position[3];
+        float normal[3];
+    };
+
+    struct Material {
+        float ambient[3] = {1, 1, 1};
+        float diffuse[3] = {1, 1, 1};
+        float specular[3] = {0.5f, 0.5f, 0.5f};
+        float shininess = 32;
+    };
+
+    enum LightKind {
+        DIRECTIONAL,
+        POINT,
+        SPOT
+    };
+
+    struct Light {
+        LightKind kind = POINT;
+        float position[3] = {0, 0, 0};
+        float direction[3] = {0, -1, 0};
+        float ambient[3] = {0.1f, 0.1f, 0.1f};
+        float diffuse[3] = {1, 1, 1};
+        float specular[3] = {1, 1, 1};
+        float constant = 1;
+        float linear = 0;
+        float quadratic = 0;
+        float cutOff = 0.976f; // Cosine of the inner cone angle
+        float outerCutOff = 0.953f; // Cosine of the outer cone angle
+    };
+
+    struct View {
+        float position[3];
+        float right[3];
+        float up[3];
+        float forward[3]; // Viewing direction
+        float fovY; // Degrees
+        float aspectRatio;
+        float nearClip;
+        float farClip;
+    };
+
+    struct Stats {
+        size_t drawCalls = 0;
+        size_t triangles = 0; // Submitted triangles
+        size_t culledTriangles = 0; // Outside of the frustum, back facing or degenerate
+        size_t clippedTriangles = 0; // Intersecting the near plane
+        size_t tileReferences = 0;
+        size_t shadedPixels = 0;
+        float vertexTime = 0; // Milliseconds
+        float setupTime = 0;
+        float rasterTime = 0;
+    };
+
+    SoftRasterizer(int width, int height)
+            : width(width),
+              height(height),
+              tilesX((width + TILE_SIZE - 1) / TILE_SIZE),
+              tilesY((height + TILE_SIZE - 1) / TILE_SIZE),
+              color(static_cast<size_t>(width * height * 3)),
+              depth(static_cast<size_t>(width * height), 1.0f) {
+        rasterRow = getCpuLevel() == CPU_AVX2 ? &SoftRasterizer::rasterRowAvx2 : &SoftRasterizer::rasterRowDefault;
+    }
+
+    void setView(const View &value) {
+        view = value;
+    }
+
+    void setClearColor(float r, float g, float b) {
+        clearColor[0] = r;
+        clearColor[1] = g;
+        clearColor[2] = b;
+    }
+
+    void setCullBackFaces(bool value) {
+        cullBackFaces = value;
+    }
+
+    // Depth only rendering skips the shading, the color buffer is left untouched.
+    void setShading(bool value) {
+        shading = value;
+    }
+
+    void setLights(std::vector<Light> value) {
+        lights = std::move(value);
+    }
+
+    uint32_t addMaterial(const Material &material) {
+        materials.emplace_back(material);
+        return static_cast<uint32_t>(materials.size() - 1);
+    }
+
+    /**
+     * Queue a draw, the vertex and index data is referenced until the next render() and must stay alive.
+     *
+     * @param model Column major model matrix
+     */
+    void draw(const Vertex *vertices,
+              size_t vertexCount,
+              const uint32_t *indices,
+              size_t indexCount,
+              const float model[16],
+              uint32_t material) {
+        DrawCall call{};
+        call.vertices = vertices;
+        call.vertexCount = vertexCount;
+        call.indices = indices;
+        call.indexCount = indexCount - indexCount % 3;
+        std::memcpy(call.model, model, sizeof(call.model));
+        call.material = material;
+        draws.emplace_back(call);
+    }
+
+    void clearDraws() {
+        draws.clear();
+        materials.clear();
+    }
+
+    // Rasterize and shade the queued draws into the color and depth buffers.
+    void render() {
+        stats = {};
+        stats.drawCalls = draws.size();
+
+        auto start = std::chrono::steady_clock::now();
+        transformVertices();
+        auto vertexEnd = std::chrono::steady_clock::now();
+        setupTriangles();
+        auto setupEnd = std::chrono::steady_clock::now();
+
+        auto tileCount = tilesX * tilesY;
+        tileShadedPixels.assign(static_cast<size_t>(tileCount), 0);
+#pragma omp parallel for schedule(dynamic)
+        for (int tile = 0; tile < tileCount; tile++)
+            renderTile(tile);
+
+        for (auto count: tileShadedPixels)
+            stats.shadedPixels += count;
+
+        auto end = std::chrono::steady_clock::now();
+        stats.vertexTime = std::chrono::duration<float, std::milli>(vertexEnd - start).count();
+        stats.setupTime = std::chrono::duration<float, std::milli>(setupEnd - vertexEnd).count();
+        stats.rasterTime = std::chrono::duration<float, std::milli>(end - setupEnd).count();
+    }
+
+    // Column major projection * view matrix of the current view, clip space as in opengl
+    void getViewProjection(float out[16]) const {
+        const float *r = view.right;
+        const float *u = view.up;
+        const float *f = view.forward;
+        const float *p = view.position;
+
+        // The camera looks along negative z in eye space
+        float viewMatrix[16] = {
+                r[0], u[0], -f[0], 0,
+                r[1], u[1], -f[1], 0,
+                r[2], u[2], -f[2], 0,
+                -(r[0] * p[0] + r[1] * p[1] + r[2] * p[2]),
+                -(u[0] * p[0] + u[1] * p[1] + u[2] * p[2]),
+                f[0] * p[0] + f[1] * p[1] + f[2] * p[2],
+                1
+        };
+
+        float t = 1.0f / std::tan(view.fovY * 0.5f * 3.14159265f / 180.0f);
+        float n = view.nearClip;
+        float fa = view.farClip;
+        float projection[16] = {
+                t / view.aspectRatio, 0, 0, 0,
+                0, t, 0, 0,
+                0, 0, -(fa + n) / (fa - n), -1,
+                0, 0, -2 * fa * n / (fa - n), 0
+        };
+
+        multiply(projection, viewMatrix, out);
+    }
+
+    int getWidth() const {
+        return width;
+    }
+
+    int getHeight() const {
+        return height;
+    }
+
+    // Rows from top to bottom, 8 bit rgb
+    const std::vector<uint8_t> &getColor() const {
+        return color;
+    }
+
+    // Rows from top to bottom, window space depth in [0, 1]
+    const std::vector<float> &getDepth() const {
+        return depth;
+    }
+
+    const Stats &getStats() const {
+        return stats;
+    }
+
+    void writePPM(std::ostream &stream) const {
+        stream << "P6\n" << width << " " << height << "\n255\n";
+        stream.write(reinterpret_cast<const char *>(color.data()), static_cast<std::streamsize>(color.size()));
+    }
+
+private:
+    struct DrawCall {
+        const Vertex *vertices;
+        size_t vertexCount;
+        const uint32_t *indices;
+        size_t indexCount;
+        float model[16];
+        uint32_t material;
+    };
+
+    struct ClipVertex {
+        float clip[4];
+        float world[3];
+        float normal[3];
+    };
+
+    // The edge functions are scaled so that they yield the barycentric weight of the opposite vertex
+    struct Triangle {
+        float a[3], b[3], c[3];
+        bool inclusive[3]; // Tie breaking for pixels exactly on an edge shared by two triangles
+        float z[3];
+        float invW[3];
+        float world[3][3];
+        float normal[3][3];
+        int minX, minY, maxX, maxY;
+        uint32_t material;
+    };
+
+    struct TileRef {
+        uint32_t tile;
+        uint32_t triangle;
+    };
+
+    struct Chunk {
+        std::vector<Triangle> triangles;
+        std::vector<TileRef> refs;
+        size_t culled = 0;
+        size_t clipped = 0;
+    };
+
+    static constexpr size_t CHUNK_TRIANGLES = 4096;
+    static constexpr int CHUNK_SHIFT = 13; // A chunk emits at most 2 triangles per input triangle
+    static constexpr uint32_t EMPTY = 0xffffffffu;
+
+    static void multiply(const float a[16], const float b[16], float out[16]) {
+        for (int c = 0; c < 4; c++) {
+            for (int r = 0; r < 4; r++) {
+                out[c * 4 + r] = a[r] * b[c * 4]
+                                 + a[4 + r] * b[c * 4 + 1]
+                                 + a[8 + r] * b[c * 4 + 2]
+                                 + a[12 + r] * b[c * 4 + 3];
+            }
+        }
+    }
+
+    void transformVertices() {
+        float viewProjection[16];
+        getViewProjection(viewProjection);
+
+        drawVertexOffsets.resize(draws.size());
+        size_t total = 0;
+        for (size_t i = 0; i < draws.size(); i++) {
+            drawVertexOffsets[i] = total;
+            total += draws[i].vertexCount;
+        }
+        clipVertices.resize(total);
+
+        for (size_t d = 0; d < draws.size(); d++) {
+            auto &call = draws[d];
+            const float *m = call.model;
+
+            float mvp[16];
+            multiply(viewProjection, m, mvp);
+
+            // Cofactors of the upper 3x3, the inverse transpose up to the scale which is removed by normalizing
+            float normalMatrix[9] = {
+                    m[5] * m[10] - m[6] * m[9], m[6] * m[8] - m[4] * m[10], m[4] * m[9] - m[5] * m[8],
+                    m[2] * m[9] - m[1] * m[10], m[0] * m[10] - m[2] * m[8], m[1] * m[8] - m[0] * m[9],
+                    m[1] * m[6] - m[2] * m[5], m[2] * m[4] - m[0] * m[6], m[0] * m[5] - m[1] * m[4]
+            };
+            float det = m[0] * normalMatrix[0] + m[4] * normalMatrix[1] + m[8] * normalMatrix[2];
+            if (det < 0) {
+                for (auto &v: normalMatrix)
+                    v = -v;
+            }
+
+            auto *out = clipVertices.data() + drawVertexOffsets[d];
+            auto count = static_cast<long>(call.vertexCount);
+#pragma omp parallel for if(count > 4096)
+            for (long i = 0; i < count; i++) {
+                auto &in = call.vertices[i];
+                auto &o = out[i];
+                float x = in.position[0], y = in.position[1], z = in.position[2];
+                for (int r = 0; r < 4; r++)
+                    o.clip[r] = mvp[r] * x + mvp[4 + r] * y + mvp[8 + r] * z + mvp[12 + r];
+                for (int r = 0; r < 3; r++)
+                    o.world[r] = m[r] * x + m[4 + r] * y + m[8 + r] * z + m[12 + r];
+                float nx = in.normal[0], ny = in.normal[1], nz = in.normal[2];
+                for (int r = 0; r < 3; r++)
+                    o.normal[r] = normalMatrix[r * 3] * nx + normalMatrix[r * 3 + 1] * ny + normalMatrix[r * 3 + 2] * nz;
+            }
+        }
+    }
+
+    void setupTriangles() {
+        drawTriangleOffsets.resize(draws.size() + 1);
+        size_t total = 0;
+        for (size_t i = 0; i < draws.size(); i++) {
+            drawTriangleOffsets[i] = total;
+            total += draws[i].indexCount / 3;
+        }
+        drawTriangleOffsets[draws.size()] = total;
+        stats.triangles = total;
+
+        auto chunkCount = (total + CHUNK_TRIANGLES - 1) / CHUNK_TRIANGLES;
+        chunks.resize(chunkCount);
+
+#pragma omp parallel for schedule(dynamic)
+        for (long c = 0; c < static_cast<long>(chunkCount); c++)
+            setupChunk(static_cast<size_t>(c));
+
+        // Counting sort of the tile references, chunks are visited in submission order
+        auto tileCount = static_cast<size_t>(tilesX * tilesY);
+        tileOffsets.assign(tileCount + 1, 0);
+        for (auto &chunk: chunks) {
+            for (auto &ref: chunk.refs)
+                tileOffsets[ref.tile + 1]++;
+            stats.culledTriangles += chunk.culled;
+            stats.clippedTriangles += chunk.clipped;
+        }
+        for (size_t i = 0; i < tileCount; i++)
+            tileOffsets[i + 1] += tileOffsets[i];
+
+        tileTriangles.resize(tileOffsets[tileCount]);
+        tileCursors.assign(tileOffsets.begin(), tileOffsets.end() - 1);
+        for (size_t c = 0; c < chunks.size(); c++) {
+            for (auto &ref: chunks[c].refs)
+                tileTriangles[tileCursors[ref.tile]++] = static_cast<uint32_t>(c << CHUNK_SHIFT) | ref.triangle;
+        }
+        stats.tileReferences = tileTriangles.size();
+    }
+
+    void setupChunk(size_t index) {
+        auto &chunk = chunks[index];
+        chunk.triangles.clear();
+        chunk.refs.clear();
+        chunk.culled = 0;
+        chunk.clipped = 0;
+
+        size_t begin = index * CHUNK_TRIANGLES;
+        size_t end = std::min(begin + CHUNK_TRIANGLES, drawTriangleOffsets.back());
+
+        size_t d = static_cast<size_t>(std::upper_bound(drawTriangleOffsets.begin(),
+                                                        drawTriangleOffsets.end(),
+                                                        begin) - drawTriangleOffsets.begin()) - 1;
+        for (size_t t = begin; t < end; t++) {
+            while (t >= drawTriangleOffsets[d + 1])
+                d++;
+            auto &call = draws[d];
+            auto *base = clipVertices.data() + drawVertexOffsets[d];
+            auto i = (t - drawTriangleOffsets[d]) * 3;
+            auto i0 = call.indices[i], i1 = call.indices[i + 1], i2 = call.indices[i + 2];
+            if (i0 >= call.vertexCount || i1 >= call.vertexCount || i2 >= call.vertexCount) {
+                chunk.culled++;
+                continue;
+            }
+            setupTriangle(chunk, base[i0], base[i1], base[i2], call.material);
+        }
+    }
+
+    static bool outside(const ClipVertex &a, const ClipVertex &b, const ClipVertex &c, int axis, float sign) {
+        return sign * a.clip[axis] > a.clip[3] && sign * b.clip[axis] > b.clip[3] && sign * c.clip[axis] > c.clip[3];
+    }
+
+    static ClipVertex lerp(const ClipVertex &a, const ClipVertex &b, float t) {
+        ClipVertex ret{};
+        for (int i = 0; i < 4; i++)
+            ret.clip[i] = a.clip[i] + (b.clip[i] - a.clip[i]) * t;
+        for (int i = 0; i < 3; i++) {
+            ret.world[i] = a.world[i] + (b.world[i] - a.world[i]) * t;
+            ret.normal[i] = a.normal[i] + (b.normal[i] - a.normal[i]) * t;
+        }
+        return ret;
+    }
+
+    void setupTriangle(Chunk &chunk, const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2, uint32_t material) {
+        // Trivial reject against the frustum planes, far included
+        if (outside(v0, v1, v2, 0, 1) || outside(v0, v1, v2, 0, -1)
+            || outside(v0, v1, v2, 1, 1) || outside(v0, v1, v2, 1, -1)
+            || outside(v0, v1, v2, 2, 1)) {
+            chunk.culled++;
+            return;
+        }
+
+        const ClipVertex *in[3] = {&v0, &v1, &v2};
+        bool inFront[3];
+        int frontCount = 0;
+        for (int i = 0; i < 3; i++) {
+            inFront[i] = in[i]->clip[2] + in[i]->clip[3] >= 0;
+            frontCount += inFront[i];
+        }
+
+        if (frontCount == 0) {
+            chunk.culled++;
+            return;
+        }
+
+        if (frontCount == 3) {
+            emitTriangle(chunk, v0, v1, v2, material);
+            return;
+        }
+
+        // Clip against the near plane (z = -w), the result is a triangle or a quad
+        chunk.clipped++;
+        ClipVertex polygon[4];
+        int count = 0;
+        for (int i = 0; i < 3; i++) {
+            auto &a = *in[i];
+            auto &b = *in[(i + 1) % 3];
+            if (inFront[i])
+                polygon[count++] = a;
+            if (inFront[i] != inFront[(i + 1) % 3]) {
+                float da = a.clip[2] + a.clip[3];
+                float db = b.clip[2] + b.clip[3];
+                polygon[count++] = lerp(a, b, da / (da - db));
+            }
+        }
+        for (int i = 1; i + 1 < count; i++)
+            emitTriangle(chunk, polygon[0], polygon[i], polygon[i + 1], material);
+    }
+
+    void emitTriangle(Chunk &chunk, const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2, uint32_t material) {
+        const ClipVertex *v[3] = {&v0, &v1, &v2};
+        float sx[3], sy[3];
+        Triangle tri{};
+        for (int i = 0; i < 3; i++) {
+            float invW = 1.0f / v[i]->clip[3];
+            sx[i] = (v[i]->clip[0] * invW * 0.5f + 0.5f) * static_cast<float>(width);
+            sy[i] = (0.5f - v[i]->clip[1] * invW * 0.5f) * static_cast<float>(height);
+            tri.z[i] = v[i]->clip[2] * invW * 0.5f + 0.5f;
+            tri.invW[i] = invW;
+        }
+
+        // Counter clockwise triangles in normalized device coordinates have a negative area in window space
+        float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]);
+        if (area == 0 || !std::isfinite(area) || (cullBackFaces && area > 0)) {
+            chunk.culled++;
+            return;
+        }
+
+        int order[3] = {0, 1, 2};
+        if (area > 0) {
+            std::swap(order[1], order[2]);
+            area = -area;
+        }
+
+        float x[3], y[3];
+        for (int i = 0; i < 3; i++) {
+            auto o = order[i];
+            x[i] = sx[o];
+            y[i] = sy[o];
+            for (int j = 0; j < 3; j++) {
+                tri.world[i][j] = v[o]->world[j];
+                tri.normal[i][j] = v[o]->normal[j];
+            }
+        }
+        float z[3] = {tri.z[order[0]], tri.z[order[1]], tri.z[order[2]]};
+        float invW[3] = {tri.invW[order[0]], tri.invW[order[1]], tri.invW[order[2]]};
+        std::copy(z, z + 3, tri.z);
+        std::copy(invW, invW + 3, tri.invW);
+
+        // Weight of vertex i is the edge function of the opposite edge divided by the area
+        float invArea = 1.0f / area;
+        for (int i = 0; i < 3; i++) {
+            int j = (i + 1) % 3;
+            int k = (i + 2) % 3;
+            float a = y[j] - y[k];
+            float b = x[k] - x[j];
+            tri.a[i] = a * invArea;
+            tri.b[i] = b * invArea;
+            tri.c[i] = (x[j] * y[k] - x[k] * y[j]) * invArea;
+            tri.inclusive[i] = a > 0 || (a == 0 && b > 0);
+        }
+
+        float minX = std::min(x[0], std::min(x[1], x[2]));
+        float maxX = std::max(x[0], std::max(x[1], x[2]));
+        float minY = std::min(y[0], std::min(y[1], y[2]));
+        float maxY = std::max(y[0], std::max(y[1], y[2]));
+        tri.minX = std::max(0, static_cast<int>(std::floor(minX)));
+        tri.minY = std::max(0, static_cast<int>(std::floor(minY)));
+        tri.maxX = std::min(width - 1, static_cast<int>(std::ceil(maxX)));
+        tri.maxY = std::min(height - 1, static_cast<int>(std::ceil(maxY)));
+        if (tri.minX > tri.maxX || tri.minY > tri.maxY) {
+            chunk.culled++;
+            return;
+        }
+
+        tri.material = material;
+
+        auto triangle = static_cast<uint32_t>(chunk.triangles.size());
+        chunk.triangles.emplace_back(tri);
+        for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ty++) {
+            for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; tx++)
+                chunk.refs.emplace_back(TileRef{static_cast<uint32_t>(ty * tilesX + tx), triangle});
+        }
+    }
+
+    const Triangle &getTriangle(uint32_t ref) const {
+        return chunks[ref >> CHUNK_SHIFT].triangles[ref & ((1u << CHUNK_SHIFT) - 1)];
+    }
+
+    typedef void (SoftRasterizer::*RasterRow)(const Triangle &, uint32_t, float, int, int, float *, uint32_t *) const;
+
+    // Depth test one row of the triangle inside the tile, 8 pixels at a time so that the loop vectorizes.
+    // The row pointers address the tile local buffers at the first pixel of the span,
+    // the triangle is copied into locals because the compiler cannot prove that the rows do not alias it.
+#define XSAMPLES_RASTER_ROW_LOOP                                                                        \
+        const float a0 = tri.a[0], a1 = tri.a[1], a2 = tri.a[2];                                        \
+        const float r0 = tri.b[0] * py + tri.c[0];                                                      \
+        const float r1 = tri.b[1] * py + tri.c[1];                                                      \
+        const float r2 = tri.b[2] * py + tri.c[2];                                                      \
+        const bool i0 = tri.inclusive[0], i1 = tri.inclusive[1], i2 = tri.inclusive[2];                 \
+        const float z0 = tri.z[0], z1 = tri.z[1], z2 = tri.z[2];                                        \
+        for (int x = x0; x <= x1; x += 8) {                                                             \
+            for (int k = 0; k < 8; k++) {                                                               \
+                float px = static_cast<float>(x + k) + 0.5f;                                            \
+                float w0 = a0 * px + r0;                                                                \
+                float w1 = a1 * px + r1;                                                                \
+                float w2 = a2 * px + r2;                                                                \
+                float z = w0 * z0 + w1 * z1 + w2 * z2;                                                  \
+                int i = x - x0 + k;                                                                     \
+                bool pass = ((w0 > 0) | ((w0 == 0) & i0))                                               \
+                            & ((w1 > 0) | ((w1 == 0) & i1))                                             \
+                            & ((w2 > 0) | ((w2 == 0) & i2))                                             \
+                            & (x + k <= x1)                                                             \
+                            & (z >= 0) & (z <= 1) & (z < depthRow[i]);                                  \
+                depthRow[i] = pass ? z : depthRow[i];                                                   \
+                visibilityRow[i] = pass ? ref : visibilityRow[i];                                       \
+            }                                                                                           \
+        }
+
+    void rasterRowDefault(const Triangle &tri, uint32_t ref, float py, int x0, int x1,
+                          float *depthRow, uint32_t *visibilityRow) const {
+        XSAMPLES_RASTER_ROW_LOOP
+    }
+
+    XSAMPLES_TARGET("avx2,fma")
+    void rasterRowAvx2(const Triangle &tri, uint32_t ref, float py, int x0, int x1,
+                       float *depthRow, uint32_t *visibilityRow) const {
+        XSAMPLES_RASTER_ROW_LOOP
+    }
+
+#undef XSAMPLES_RASTER_ROW_LOOP
+
+    void renderTile(int tile) {
+        // One padding span so that the 8 wide loop never writes outside of the row
+        float tileDepth[TILE_SIZE * (TILE_SIZE + 8)];
+        uint32_t tileVisibility[TILE_SIZE * (TILE_SIZE + 8)];
+        const int stride = TILE_SIZE + 8;
+
+        int tileX = (tile % tilesX) * TILE_SIZE;
+        int tileY = (tile / tilesX) * TILE_SIZE;
+        int tileW = std::min(TILE_SIZE, width - tileX);
+        int tileH = std::min(TILE_SIZE, height - tileY);
+
+        std::fill(tileDepth, tileDepth + stride * TILE_SIZE, 1.0f);
+        std::fill(tileVisibility, tileVisibility + stride * TILE_SIZE, EMPTY);
+
+        for (auto i = tileOffsets[tile]; i < tileOffsets[tile + 1]; i++) {
+            auto ref = tileTriangles[i];
+            auto &tri = getTriangle(ref);
+            int x0 = std::max(tri.minX, tileX);
+            int x1 = std::min(tri.maxX, tileX + tileW - 1);
+            int y0 = std::max(tri.minY, tileY);
+            int y1 = std::min(tri.maxY, tileY + tileH - 1);
+            for (int y = y0; y <= y1; y++) {
+                auto offset = (y - tileY) * stride + (x0 - tileX);
+                (this->*rasterRow)(tri, ref, static_cast<float>(y) + 0.5f, x0, x1,
+                                   tileDepth + offset, tileVisibility + offset);
+            }
+        }
+
+        for (int y = 0; y < tileH; y++) {
+            std::copy(tileDepth + y * stride,
+                      tileDepth + y * stride + tileW,
+                      depth.data() + static_cast<size_t>((tileY + y) * width + tileX));
+        }
+
+        size_t shaded = 0;
+        if (shading) {
+            uint8_t clear[3];
+            toColor(clearColor, clear);
+            for (int y = 0; y < tileH; y++) {
+                auto *out = color.data() + static_cast<size_t>((tileY + y) * width + tileX) * 3;
+                auto *visibility = tileVisibility + y * stride;
+                for (int x = 0; x < tileW; x++, out += 3) {
+                    if (visibility[x] == EMPTY) {
+                        out[0] = clear[0];
+                        out[1] = clear[1];
+                        out[2] = clear[2];
+                        continue;
+                    }
+                    float rgb[3];
+                    shade(getTriangle(visibility[x]),
+                          static_cast<float>(tileX + x) + 0.5f,
+                          static_cast<float>(tileY + y) + 0.5f,
+                          rgb);
+                    toColor(rgb, out);
+                    shaded++;
+                }
+            }
+        }
+        tileShadedPixels[tile] = shaded;
+    }
+
+    static void toColor(const float rgb[3], uint8_t out[3]) {
+        for (int c = 0; c < 3; c++)
+            out[c] = static_cast<uint8_t>(std::min(1.0f, std::max(0.0f, rgb[c])) * 255.0f + 0.5f);
+    }
+
+    static float dot(const float a[3], const float b[3]) {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    static void normalize(float v[3]) {
+        float length = std::sqrt(dot(v, v));
+        if (length > 0) {
+            for (int i = 0; i < 3; i++)
+                v[i] /= length;
+        }
+    }
+
+    // Perspective correct interpolation of the vertex attributes and the phong model of the forward renderer
+    void shade(const Triangle &tri, float px, float py, float rgb[3]) const {
+        float weights[3];
+        float sum = 0;
+        for (int i = 0; i < 3; i++) {
+            weights[i] = (tri.a[i] * px + tri.b[i] * py + tri.c[i]) * tri.invW[i];
+            sum += weights[i];
+        }
+        for (auto &w: weights)
+            w /= sum;
+
+        float position[3], normal[3];
+        for (int c = 0; c < 3; c++) {
+            position[c] = weights[0] * tri.world[0][c] + weights[1] * tri.world[1][c] + weights[2] * tri.world[2][c];
+            normal[c] = weights[0] * tri.normal[0][c] + weights[1] * tri.normal[1][c] + weights[2] * tri.normal[2][c];
+        }
+        normalize(normal);
+
+        float viewDir[3] = {view.position[0] - position[0],
+                            view.position[1] - position[1],
+                            view.position[2] - position[2]};
+        normalize(viewDir);
+
+        auto &material = materials.at(tri.material);
+        rgb[0] = rgb[1] = rgb[2] = 0;
+
+        for (auto &light: lights) {
+            float lightDir[3];
+            float attenuation = 1;
+            if (light.kind == DIRECTIONAL) {
+                for (int c = 0; c < 3; c++)
+                    lightDir[c] = -light.direction[c];
+                normalize(lightDir);
+            } else {
+                for (int c = 0; c < 3; c++)
+                    lightDir[c] = light.position[c] - position[c];
+                float distance = std::sqrt(dot(lightDir, lightDir));
+                normalize(lightDir);
+                attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+                if (light.kind == SPOT) {
+                    float spotDir[3] = {-light.direction[0], -light.direction[1], -light.direction[2]};
+                    normalize(spotDir);
+                    float theta = dot(lightDir, spotDir);
+                    float epsilon = light.cutOff - light.outerCutOff;
+                    float intensity = epsilon == 0
+                                      ? (theta >= light.cutOff ? 1.0f : 0.0f)
+                                      : (theta - light.outerCutOff) / epsilon;
+                    attenuation *= std::min(1.0f, std::max(0.0f, intensity));
+                }
+            }
+
+            float diffuse = std::max(dot(normal, lightDir), 0.0f);
+
+            float d = 2 * dot(normal, lightDir);
+            float reflectDir[3] = {d * normal[0] - lightDir[0],
+                                   d * normal[1] - lightDir[1],
+                                   d * normal[2] - lightDir[2]};
+            float specular = diffuse > 0 ? std::pow(std::max(dot(viewDir, reflectDir), 0.0f), material.shininess) : 0;
+
+            for (int c = 0; c < 3; c++) {
+                rgb[c] += (light.ambient[c] * material.ambient[c]
+                           + light.diffuse[c] * diffuse * material.diffuse[c]
+                           + light.specular[c] * specular * material.specular[c]) * attenuation;
+            }
+        }
+    }
+
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+
+    View view{};
+    float clearColor[3] = {0, 0, 0};
+    bool cullBackFaces = true;
+    bool shading = true;
+
+    std::vector<Light> lights;
+    std::vector<Material> materials;
+    std::vector<DrawCall> draws;
+
+    std::vector<size_t> drawVertexOffsets;
+    std::vector<size_t> drawTriangleOffsets;
+    std::vector<ClipVertex> clipVertices;
+
+    std::vector<Chunk> chunks;
+    std::vector<size_t> tileOffsets;
+    std::vector<size_t> tileCursors;
+    std::vector<uint32_t> tileTriangles;
+    std::vector<size_t> tileShadedPixels;
+
+    RasterRow rasterRow;
+
+    std::vector<uint8_t> color;
+    std::vector<float> depth;
+
+    Stats stats;
+};
+
+#endif //XSAMPLES_SOFTRASTERIZER_HPP
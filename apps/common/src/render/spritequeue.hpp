@@ -0,0 +1,170 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_SPRITEQUEUE_HPP
+#define XSAMPLES_SPRITEQUEUE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+struct SpriteQueueStats {
+    size_t sprites = 0;
+    size_t batches = 0; // Runs of sprites with the same layer and texture
+    size_t unsortedBatches = 0; // The batches the sprites would have formed in submission order
+};
+
+// Collects 2d draws for a frame and submits them grouped by layer and texture.
+// Sprites of the same layer are assumed not to depend on each other's order unless they share a texture,
+// the submission order inside a batch is preserved. There are only a few distinct layer / texture keys per frame,
+// so the sprites are ordered with a counting sort over the keys instead of a comparison sort.
+// The storage is kept across frames.
+template<typename T>
+class SpriteQueue {
+public:
+    typedef SpriteQueueStats Stats;
+
+    void clear() {
+        entries.clear();
+        textures.clear();
+        batches.clear();
+        sorted = true;
+    }
+
+    // texture only identifies the state, it is never dereferenced. nullptr is used for untextured sprites.
+    void push(const void *texture, int layer, const T &sprite) {
+        auto key = (static_cast<uint32_t>(layer + 32768) << 16) | getTextureId(texture);
+        if (!entries.empty() && key < entries.back().key)
+            sorted = false;
+        auto batch = getBatch(key);
+        batches[batch].count++;
+        entries.emplace_back(Entry{key, batch, texture, sprite});
+    }
+
+    /**
+     * Sort the sprites and pass them to submit in batch order, the queue is cleared afterwards.
+     *
+     * @param submit Called with (const void *texture, const T &sprite, bool newBatch)
+     */
+    template<typename F>
+    void flush(F &&submit) {
+        stats = {};
+        stats.sprites = entries.size();
+        stats.unsortedBatches = countBatches();
+        stats.batches = batches.size();
+
+        if (sorted) {
+            for (size_t i = 0; i < entries.size(); i++)
+                submit(entries[i].texture, entries[i].sprite, i == 0 || entries[i].key != entries[i - 1].key);
+            clear();
+            return;
+        }
+
+        batchOrder.resize(batches.size());
+        for (size_t i = 0; i < batches.size(); i++)
+            batchOrder[i] = static_cast<uint32_t>(i);
+        std::sort(batchOrder.begin(), batchOrder.end(), [this](uint32_t a, uint32_t b) {
+            return batches[a].key < batches[b].key;
+        });
+        uint32_t offset = 0;
+        for (auto index: batchOrder) {
+            batches[index].offset = offset;
+            offset += batches[index].count;
+        }
+
+        order.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); i++)
+            order[batches[entries[i].batch].offset++] = static_cast<uint32_t>(i);
+
+        for (size_t i = 0; i < order.size(); i++) {
+            auto &entry = entries[order[i]];
+            submit(entry.texture, entry.sprite, i == 0 || entry.key != entries[order[i - 1]].key);
+        }
+
+        clear();
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    // The stats of the last flush
+    const Stats &getStats() const {
+        return stats;
+    }
+
+private:
+    struct Entry {
+        uint32_t key;
+        uint32_t batch;
+        const void *texture;
+        T sprite;
+    };
+
+    struct Batch {
+        uint32_t key;
+        uint32_t count;
+        uint32_t offset;
+    };
+
+    uint32_t getBatch(uint32_t key) {
+        if (lastBatch < batches.size() && batches[lastBatch].key == key)
+            return static_cast<uint32_t>(lastBatch);
+        for (lastBatch = 0; lastBatch < batches.size(); lastBatch++) {
+            if (batches[lastBatch].key == key)
+                return static_cast<uint32_t>(lastBatch);
+        }
+        batches.emplace_back(Batch{key, 0, 0});
+        return static_cast<uint32_t>(lastBatch);
+    }
+
+    // Ids in order of first use, a frame rarely uses more than a handful of textures (at most 65536 fit the key)
+    uint32_t getTextureId(const void *texture) {
+        if (!textures.empty() && textures.back() == texture)
+            return static_cast<uint32_t>(textures.size() - 1);
+        for (size_t i = 0; i < textures.size(); i++) {
+            if (textures[i] == texture)
+                return static_cast<uint32_t>(i);
+        }
+        textures.emplace_back(texture);
+        return static_cast<uint32_t>(textures.size() - 1);
+    }
+
+    size_t countBatches() const {
+        size_t ret = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (i == 0 || entries[i].key != entries[i - 1].key)
+                ret++;
+        }
+        return ret;
+    }
+
+    std::vector<Entry> entries;
+    std::vector<const void *> textures;
+    std::vector<Batch> batches; // The distinct keys of the queued sprites
+    std::vector<uint32_t> batchOrder;
+    std::vector<uint32_t> order;
+    size_t lastBatch = 0;
+    bool sorted = true;
+
+    Stats stats;
+};
+
+#endif //XSAMPLES_SPRITEQUEUE_HPP
@@ -0,0 +1,467 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_TEXTURESTREAMER_HPP
+#define XSAMPLES_TEXTURESTREAMER_HPP
+
+#include <vector>
+#include <functional>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "concurrency/threadpool.hpp"
+
+// Keeps a subset of the mip chain of every texture in memory under a fixed byte budget.
+// Textures start with only the coarse tail of their chain resident, each frame the caller requests the
+// screen size at which a texture is drawn and update() streams in the finer levels this requires.
+// Loads decode the source image and build the chain on the thread pool, only the missing levels are kept.
+// When the budget is exhausted the finer levels of the textures which have not been requested
+// the longest are evicted first, the coarse tail is never evicted.
+class TextureStreamer {
+public:
+    // Tightly packed RGBA8 pixels
+    struct Image {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    // Returns the full resolution image, called on a worker thread. An empty image marks a failed load.
+    typedef std::function<Image()> Loader;
+
+    // Called from update() whenever the finest resident level of a texture changed.
+    typedef std::function<void(int id, int mip)> UploadCallback;
+
+    struct Stats {
+        size_t textures = 0;
+        size_t residentBytes = 0;
+        size_t budgetBytes = 0;
+        size_t wantedBytes = 0; // The resident size if the budget was unlimited
+        size_t starvedTextures = 0; // Requested finer than resident
+        size_t pendingLoads = 0;
+        unsigned long loads = 0;
+        unsigned long failedLoads = 0;
+        unsigned long evictedLevels = 0;
+        size_t streamedBytes = 0;
+        float loadTime = 0; // Milliseconds spent in the jobs which completed this frame
+    };
+
+    static const int NOT_RESIDENT = -1;
+
+    explicit TextureStreamer(ThreadPool &pool,
+                             size_t budget = 64 * 1024 * 1024,
+                             int coarseSize = 64,
+                             size_t maxPendingLoads = 2)
+            : pool(pool), budget(budget), coarseSize(coarseSize), maxPendingLoads(maxPendingLoads) {}
+
+    ~TextureStreamer() {
+        for (auto &texture: textures) {
+            if (texture.load.valid())
+                texture.load.wait();
+        }
+    }
+
+    TextureStreamer(const TextureStreamer &) = delete;
+
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+    /**
+     * The coarse tail is loaded by the next update() regardless of the budget.
+     *
+     * @return The id of the texture
+     */
+    int add(Loader loader) {
+        textures.emplace_back();
+        textures.back().loader = std::move(loader);
+        return static_cast<int>(textures.size() - 1);
+    }
+
+    void setUploadCallback(UploadCallback callback) {
+        upload = std::move(callback);
+    }
+
+    void setBudget(size_t value) {
+        budget = value;
+    }
+
+    /**
+     * Request the texture for the current frame, multiple requests keep the largest size.
+     *
+     * @param pixels The size of the texture on screen along its larger axis
+     */
+    void request(int id, float pixels) {
+        auto &texture = textures.at(static_cast<size_t>(id));
+        texture.requestedPixels = std::max(texture.requestedPixels, pixels);
+    }
+
+    // Apply completed loads, evict and start new loads for the requests since the last call.
+    void update() {
+        frame++;
+        stats.loadTime = 0;
+
+        for (size_t i = 0; i < textures.size(); i++)
+            finishLoad(static_cast<int>(i), false);
+
+        std::vector<int> candidates;
+        stats.wantedBytes = 0;
+        stats.starvedTextures = 0;
+        for (size_t i = 0; i < textures.size(); i++) {
+            auto &texture = textures[i];
+            if (texture.requestedPixels > 0)
+                texture.lastUsed = frame;
+
+            if (texture.mipCount == 0) {
+                // Nothing known about the texture yet, load the coarse tail
+                if (!texture.load.valid() && !texture.failed)
+                    startLoad(static_cast<int>(i), NOT_RESIDENT);
+                continue;
+            }
+
+            auto coarseMip = getCoarseMip(texture);
+            texture.targetMip = texture.requestedPixels > 0
+                                ? std::min(coarseMip,
+                                           getMipForSize(texture.width, texture.height, texture.requestedPixels))
+                                : coarseMip;
+            texture.requestedPixels = 0;
+
+            stats.wantedBytes += getChainBytes(texture, texture.targetMip, texture.mipCount);
+            if (texture.residentMip > texture.targetMip) {
+                stats.starvedTextures++;
+                if (!texture.load.valid())
+                    candidates.emplace_back(static_cast<int>(i));
+            }
+        }
+
+        // Textures missing the most levels first, the jobs are not cancelled so the count in flight is limited
+        std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+            auto &ta = textures[static_cast<size_t>(a)];
+            auto &tb = textures[static_cast<size_t>(b)];
+            auto ma = ta.residentMip - ta.targetMip;
+            auto mb = tb.residentMip - tb.targetMip;
+            return ma != mb ? ma > mb : a < b;
+        });
+
+        for (auto id: candidates) {
+            if (pendingLoads >= maxPendingLoads)
+                break;
+            auto &texture = textures[static_cast<size_t>(id)];
+            // Settle for a coarser level than the target if the finer ones do not fit
+            auto available = budget + getEvictableBytes(id);
+            auto mip = texture.targetMip;
+            while (mip < texture.residentMip
+                   && residentBytes + reservedBytes + getChainBytes(texture, mip, texture.residentMip) > available) {
+                mip++;
+            }
+            if (mip < texture.residentMip && makeRoom(getChainBytes(texture, mip, texture.residentMip), id))
+                startLoad(id, mip);
+        }
+
+        // The budget may have been lowered
+        makeRoom(0, NOT_RESIDENT);
+
+        stats.textures = textures.size();
+        stats.residentBytes = residentBytes;
+        stats.budgetBytes = budget;
+        stats.pendingLoads = pendingLoads;
+    }
+
+    // Block until all loads in flight completed and apply them.
+    void flush() {
+        for (size_t i = 0; i < textures.size(); i++)
+            finishLoad(static_cast<int>(i), true);
+        stats.residentBytes = residentBytes;
+        stats.pendingLoads = pendingLoads;
+    }
+
+    /**
+     * @return The finest level which still has at least the given size in pixels along the larger axis.
+     */
+    static int getMipForSize(int width, int height, float pixels) {
+        auto size = static_cast<float>(std::max(width, height));
+        if (pixels >= size)
+            return 0;
+        auto mip = static_cast<int>(std::floor(std::log2(size / std::max(pixels, 1.0f))));
+        return std::min(mip, getMipCount(width, height) - 1);
+    }
+
+    static int getMipCount(int width, int height) {
+        int count = 1;
+        while ((std::max(width, height) >> count) > 0)
+            count++;
+        return count;
+    }
+
+    static size_t getLevelBytes(int width, int height, int mip) {
+        return static_cast<size_t>(std::max(1, width >> mip)) * static_cast<size_t>(std::max(1, height >> mip)) * 4;
+    }
+
+    /**
+     * Box filter to the next level, odd sizes are rounded down and the last row / column is clamped.
+     */
+    static Image downsample(const Image &src) {
+        Image dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.pixels.resize(static_cast<size_t>(dst.width) * static_cast<size_t>(dst.height) * 4);
+
+        auto stride = static_cast<size_t>(src.width) * 4;
+        for (int y = 0; y < dst.height; y++) {
+            auto row0 = src.pixels.data() + static_cast<size_t>(std::min(y * 2, src.height - 1)) * stride;
+            auto row1 = src.pixels.data() + static_cast<size_t>(std::min(y * 2 + 1, src.height - 1)) * stride;
+            auto out = dst.pixels.data() + static_cast<size_t>(y) * static_cast<size_t>(dst.width) * 4;
+            for (int x = 0; x < dst.width; x++) {
+                auto x0 = static_cast<size_t>(std::min(x * 2, src.width - 1)) * 4;
+                auto x1 = static_cast<size_t>(std::min(x * 2 + 1, src.width - 1)) * 4;
+                for (size_t c = 0; c < 4; c++) {
+                    unsigned sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                    out[static_cast<size_t>(x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+        return dst;
+    }
+
+    /**
+     * @return The finest level in memory or NOT_RESIDENT, all coarser levels are resident as well.
+     */
+    int getResidentMip(int id) const {
+        return textures.at(static_cast<size_t>(id)).residentMip;
+    }
+
+    int getTargetMip(int id) const {
+        return textures.at(static_cast<size_t>(id)).targetMip;
+    }
+
+    int getMipCount(int id) const {
+        return textures.at(static_cast<size_t>(id)).mipCount;
+    }
+
+    const Image &getLevel(int id, int mip) const {
+        return textures.at(static_cast<size_t>(id)).mips.at(static_cast<size_t>(mip));
+    }
+
+    size_t getTextureCount() const {
+        return textures.size();
+    }
+
+    const Stats &getStats() const {
+        return stats;
+    }
+
+private:
+    struct Load {
+        int width = 0;
+        int height = 0;
+        int firstMip = 0;
+        std::vector<Image> mips; // From firstMip up to the previously resident level
+        float time = 0;
+    };
+
+    struct Texture {
+        Loader loader;
+        int width = 0;
+        int height = 0;
+        int mipCount = 0; // 0 until the first load completed
+        int residentMip = NOT_RESIDENT;
+        int targetMip = 0;
+        float requestedPixels = 0;
+        unsigned long lastUsed = 0;
+        bool failed = false;
+        int loadMip = NOT_RESIDENT;
+        std::vector<Image> mips; // Levels finer than residentMip are empty
+        std::future<Load> load;
+    };
+
+    int getCoarseMip(const Texture &texture) const {
+        return getMipForSize(texture.width, texture.height, static_cast<float>(coarseSize));
+    }
+
+    size_t getChainBytes(const Texture &texture, int begin, int end) const {
+        size_t ret = 0;
+        for (int mip = std::max(begin, 0); mip < end; mip++)
+            ret += getLevelBytes(texture.width, texture.height, mip);
+        return ret;
+    }
+
+    // Levels of pending loads are accounted when the load starts so that they always fit once completed.
+    void startLoad(int id, int mip) {
+        auto &texture = textures[static_cast<size_t>(id)];
+        auto end = texture.residentMip == NOT_RESIDENT ? texture.mipCount : texture.residentMip;
+        if (mip != NOT_RESIDENT)
+            reservedBytes += getChainBytes(texture, mip, end);
+
+        auto loader = texture.loader;
+        auto coarse = coarseSize;
+        texture.load = pool.submit([loader, mip, end, coarse]() {
+            return runLoad(loader, mip, end, coarse);
+        });
+        texture.loadMip = mip;
+        pendingLoads++;
+    }
+
+    void finishLoad(int id, bool wait) {
+        auto &texture = textures[static_cast<size_t>(id)];
+        if (!texture.load.valid())
+            return;
+        if (!wait && texture.load.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+
+        auto load = texture.load.get();
+        pendingLoads--;
+        stats.loadTime += load.time;
+
+        auto end = texture.residentMip == NOT_RESIDENT ? texture.mipCount : texture.residentMip;
+        if (texture.loadMip != NOT_RESIDENT)
+            reservedBytes -= getChainBytes(texture, texture.loadMip, end);
+
+        if (load.mips.empty()) {
+            texture.failed = texture.mipCount == 0;
+            stats.failedLoads++;
+            return;
+        }
+
+        if (texture.mipCount == 0) {
+            texture.width = load.width;
+            texture.height = load.height;
+            texture.mipCount = getMipCount(load.width, load.height);
+            texture.mips.resize(static_cast<size_t>(texture.mipCount));
+            texture.targetMip = load.firstMip;
+        }
+
+        for (size_t i = 0; i < load.mips.size(); i++) {
+            auto mip = static_cast<size_t>(load.firstMip) + i;
+            residentBytes += load.mips[i].pixels.size();
+            stats.streamedBytes += load.mips[i].pixels.size();
+            texture.mips.at(mip) = std::move(load.mips[i]);
+        }
+        texture.residentMip = load.firstMip;
+        stats.loads++;
+
+        if (upload)
+            upload(id, texture.residentMip);
+    }
+
+    bool isEvictable(const Texture &texture) const {
+        return !texture.load.valid()
+               && texture.residentMip != NOT_RESIDENT
+               && texture.residentMip < texture.targetMip;
+    }
+
+    size_t getEvictableBytes(int excluded) const {
+        size_t ret = 0;
+        for (size_t i = 0; i < textures.size(); i++) {
+            if (static_cast<int>(i) != excluded && isEvictable(textures[i]))
+                ret += getChainBytes(textures[i], textures[i].residentMip, textures[i].targetMip);
+        }
+        return ret;
+    }
+
+    /**
+     * Evict levels which are finer than their target, least recently requested textures first,
+     * until the given amount of bytes fits the budget. The texture excluded is the one the room is made for.
+     *
+     * @return False if the bytes do not fit even after evicting all surplus levels
+     */
+    bool makeRoom(size_t bytes, int excluded) {
+        if (residentBytes + reservedBytes + bytes <= budget)
+            return true;
+
+        std::vector<int> victims;
+        for (size_t i = 0; i < textures.size(); i++) {
+            if (static_cast<int>(i) != excluded && isEvictable(textures[i]))
+                victims.emplace_back(static_cast<int>(i));
+        }
+        std::sort(victims.begin(), victims.end(), [this](int a, int b) {
+            return textures[static_cast<size_t>(a)].lastUsed < textures[static_cast<size_t>(b)].lastUsed;
+        });
+
+        for (auto id: victims) {
+            auto &texture = textures[static_cast<size_t>(id)];
+            auto previous = texture.residentMip;
+            while (texture.residentMip < texture.targetMip && residentBytes + reservedBytes + bytes > budget) {
+                auto &level = texture.mips.at(static_cast<size_t>(texture.residentMip));
+                residentBytes -= level.pixels.size();
+                level = {};
+                texture.residentMip++;
+                stats.evictedLevels++;
+            }
+            if (upload && texture.residentMip != previous)
+                upload(id, texture.residentMip);
+            if (residentBytes + reservedBytes + bytes <= budget)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * @param mip The first level to return or NOT_RESIDENT for the coarse tail
+     * @param end The level after the last one to return, ignored for the coarse tail
+     * @param coarseSize The size along the larger axis below which levels belong to the coarse tail
+     */
+    static Load runLoad(const Loader &loader, int mip, int end, int coarseSize) {
+        auto start = std::chrono::steady_clock::now();
+
+        Load ret;
+        auto image = loader();
+        if (image.width <= 0 || image.height <= 0
+            || image.pixels.size() != static_cast<size_t>(image.width) * static_cast<size_t>(image.height) * 4) {
+            return ret;
+        }
+
+        ret.width = image.width;
+        ret.height = image.height;
+        auto mipCount = getMipCount(image.width, image.height);
+        if (mip == NOT_RESIDENT) {
+            ret.firstMip = getMipForSize(image.width, image.height, static_cast<float>(coarseSize));
+            end = mipCount;
+        } else {
+            ret.firstMip = mip;
+        }
+
+        for (int level = 0; level < end; level++) {
+            if (level > 0)
+                image = downsample(image);
+            if (level >= ret.firstMip)
+                ret.mips.emplace_back(image);
+        }
+
+        ret.time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return ret;
+    }
+
+    ThreadPool &pool;
+    size_t budget;
+    int coarseSize;
+    size_t maxPendingLoads;
+
+    std::vector<Texture> textures;
+    UploadCallback upload;
+
+    size_t residentBytes = 0;
+    size_t reservedBytes = 0;
+    size_t pendingLoads = 0;
+    unsigned long frame = 0;
+
+    Stats stats;
+};
+
+#endif //XSAMPLES_TEXTURESTREAMER_HPP
@@ -0,0 +1,58 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_NATIVESCRIPTRUNTIME_HPP
+#define XSAMPLES_NATIVESCRIPTRUNTIME_HPP
+
+#include <map>
+#include <string>
+#include <functional>
+
+#include "scripting/scriptbatch.hpp"
+
+// Script runtime dispatching batches to registered C++ functions.
+// The packed entity data is used directly, so the component sync is free.
+class NativeScriptRuntime : public ScriptRuntime {
+public:
+    typedef std::function<void(ScriptEntityData *entities, size_t count, float deltaTime)> BatchFunction;
+
+    void registerClass(const std::string &scriptClass, BatchFunction function) {
+        classes[scriptClass] = std::move(function);
+    }
+
+    void syncIn(ScriptEntityData *, size_t) override {}
+
+    bool invokeBatch(const std::string &scriptClass,
+                     ScriptEntityData *entities,
+                     size_t count,
+                     float deltaTime) override {
+        auto it = classes.find(scriptClass);
+        if (it == classes.end())
+            return false;
+        it->second(entities, count, deltaTime);
+        return true;
+    }
+
+    void syncOut(ScriptEntityData *, size_t) override {}
+
+private:
+    std::map<std::string, BatchFunction> classes;
+};
+
+#endif //XSAMPLES_NATIVESCRIPTRUNTIME_HPP
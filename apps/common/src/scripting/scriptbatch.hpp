@@ -0,0 +1,320 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XSAMPLES_SCRIPTBATCH_HPP
+#define XSAMPLES_SCRIPTBATCH_HPP
+
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// Per entity data passed across the native / managed boundary.
+// The layout is blittable so that an array of these can be pinned and handed to the runtime as is.
+struct ScriptEntityData {
+    int32_t entity;
+    float position[3];
+    float rotation[4]; // Quaternion w x y z
+    float scale[3];
+};
+
+static_assert(std::is_trivially_copyable<ScriptEntityData>::value, "ScriptEntityData must be blittable");
+
+// The scripting runtime seen from the native side, every call is one native / managed transition.
+class ScriptRuntime {
+public:
+    virtual ~ScriptRuntime() = default;
+
+    // Copy the packed entity data into the managed component mirrors.
+    virtual void syncIn(ScriptEntityData *entities, size_t count) = 0;
+
+    /**
+     * Run the update of all instances of a script class.
+     *
+     * @return False if the class is unknown to the runtime.
+     */
+    virtual bool invokeBatch(const std::string &scriptClass,
+                             ScriptEntityData *entities,
+                             size_t count,
+                             float deltaTime) = 0;
+
+    // Copy the managed component mirrors back into the packed entity data.
+    virtual void syncOut(ScriptEntityData *entities, size_t count) = 0;
+};
+
+// Collects the scripted and synced entities of a frame into one contiguous array and dispatches it.
+// The array is ordered by update queue and script class, so each class is one slice and costs one transition,
+// and the component sync copies the synced entities, packed into their own array, in one transition in each direction.
+// With batching disabled every entity is invoked and synced on its own, which is how the per entity bridge behaves.
+class ScriptBatcher {
+public:
+    struct Stats {
+        size_t transitions = 0;
+        size_t batches = 0;
+        size_t scriptedEntities = 0;
+        size_t syncedEntities = 0;
+        size_t syncBytes = 0;
+        size_t unresolvedClasses = 0;
+        // Transitions the per entity bridge makes for the same frame, one call per scripted entity
+        // and one sync call in each direction per synced entity
+        size_t unbatchedTransitions = 0;
+    };
+
+    void setBatching(bool value) {
+        batching = value;
+    }
+
+    bool getBatching() const {
+        return batching;
+    }
+
+    void begin() {
+        entities.clear();
+        meta.clear();
+    }
+
+    /**
+     * @param scriptClass The fully qualified script class or an empty string for entities which are only synced
+     * @return The slot to fill with the current component data
+     */
+    ScriptEntityData &add(int32_t entity, const std::string &scriptClass, int queue, bool sync) {
+        int classId = -1;
+        if (!scriptClass.empty()) {
+            if (lastClassId >= 0 && classNames[lastClassId] == scriptClass) {
+                classId = lastClassId;
+            } else {
+                auto it = classIds.find(scriptClass);
+                if (it == classIds.end()) {
+                    it = classIds.emplace(scriptClass, static_cast<int>(classNames.size())).first;
+                    classNames.emplace_back(scriptClass);
+                }
+                classId = it->second;
+                lastClassId = classId;
+            }
+        }
+        entities.emplace_back();
+        entities.back().entity = entity;
+        meta.push_back({classId, queue, sync});
+        return entities.back();
+    }
+
+    void dispatch(ScriptRuntime &runtime, float deltaTime) {
+        stats = {};
+
+        sort();
+
+        size_t synced = 0;
+        for (auto &m: meta) {
+            if (m.sync)
+                synced++;
+            if (m.classId >= 0)
+                stats.scriptedEntities++;
+        }
+        stats.syncedEntities = synced;
+        stats.unbatchedTransitions = stats.scriptedEntities + synced * 2;
+
+        if (entities.empty())
+            return;
+
+        if (synced > 0) {
+            syncIn(runtime);
+        }
+
+        size_t begin = 0;
+        while (begin < entities.size() && meta.at(begin).classId >= 0) {
+            auto end = begin + 1;
+            while (end < entities.size()
+                   && meta.at(end).queue == meta.at(begin).queue
+                   && meta.at(end).classId == meta.at(begin).classId) {
+                end++;
+            }
+            invoke(runtime, classNames.at(meta.at(begin).classId), begin, end, deltaTime);
+            begin = end;
+        }
+
+        if (synced > 0) {
+            syncOut(runtime);
+        }
+    }
+
+    // The packed entities in dispatch order, holds the synced results after dispatch.
+    const std::vector<ScriptEntityData> &getEntities() const {
+        return entities;
+    }
+
+    bool isSynced(size_t index) const {
+        return meta.at(index).sync;
+    }
+
+    const Stats &getStats() const {
+        return stats;
+    }
+
+private:
+    struct Meta {
+        int classId; // Index into classNames, -1 for sync only entities
+        int queue;
+        bool sync;
+    };
+
+    // Scripted entities by queue and class, then the sync only entities. Entities keep their relative order.
+    // There are few distinct keys per frame, so this is a counting sort over the keys.
+    void sort() {
+        bucketOf.clear();
+        keys.clear();
+        entityBucket.resize(entities.size());
+        for (size_t i = 0; i < meta.size(); i++) {
+            auto key = getSortKey(meta[i]);
+            auto it = bucketOf.find(key);
+            if (it == bucketOf.end()) {
+                it = bucketOf.emplace(key, keys.size()).first;
+                keys.emplace_back(key, 0);
+            }
+            keys[it->second].second++;
+            entityBucket[i] = it->second;
+        }
+
+        // Sort the distinct keys and turn the counts into the start offsets of the buckets
+        sortedKeys.resize(keys.size());
+        std::iota(sortedKeys.begin(), sortedKeys.end(), 0);
+        std::sort(sortedKeys.begin(), sortedKeys.end(), [this](size_t a, size_t b) {
+            return keys[a].first < keys[b].first;
+        });
+        bucketOffset.resize(keys.size());
+        size_t offset = 0;
+        for (auto bucket: sortedKeys) {
+            bucketOffset[bucket] = offset;
+            offset += keys[bucket].second;
+        }
+
+        sortedEntities.resize(entities.size());
+        sortedMeta.resize(meta.size());
+        for (size_t i = 0; i < entities.size(); i++) {
+            auto target = bucketOffset[entityBucket[i]]++;
+            sortedEntities[target] = entities[i];
+            sortedMeta[target] = meta[i];
+        }
+        std::swap(entities, sortedEntities);
+        std::swap(meta, sortedMeta);
+    }
+
+    static uint64_t getSortKey(const Meta &m) {
+        // Sync only entities (class -1) get the largest key, the queue is biased so that negative queues sort first
+        if (m.classId < 0)
+            return ~static_cast<uint64_t>(0);
+        auto queue = static_cast<uint64_t>(static_cast<uint32_t>(m.queue) ^ 0x80000000u);
+        return (queue << 32) | static_cast<uint32_t>(m.classId);
+    }
+
+    // Copy the synced entities into their own contiguous slice, scripted entities without sync are left out.
+    void packSynced() {
+        syncEntities.clear();
+        syncIndices.clear();
+        for (size_t i = 0; i < entities.size(); i++) {
+            if (!meta[i].sync)
+                continue;
+            syncEntities.emplace_back(entities[i]);
+            syncIndices.emplace_back(i);
+        }
+    }
+
+    void syncIn(ScriptRuntime &runtime) {
+        if (batching) {
+            packSynced();
+            runtime.syncIn(syncEntities.data(), syncEntities.size());
+            stats.transitions++;
+            stats.syncBytes += syncEntities.size() * sizeof(ScriptEntityData);
+        } else {
+            for (size_t i = 0; i < entities.size(); i++) {
+                if (!meta.at(i).sync)
+                    continue;
+                runtime.syncIn(&entities.at(i), 1);
+                stats.transitions++;
+                stats.syncBytes += sizeof(ScriptEntityData);
+            }
+        }
+    }
+
+    void syncOut(ScriptRuntime &runtime) {
+        if (batching) {
+            // Packed again because the scripts may have changed the entity data since syncIn
+            packSynced();
+            runtime.syncOut(syncEntities.data(), syncEntities.size());
+            for (size_t i = 0; i < syncIndices.size(); i++)
+                entities[syncIndices[i]] = syncEntities[i];
+            stats.transitions++;
+            stats.syncBytes += syncEntities.size() * sizeof(ScriptEntityData);
+        } else {
+            for (size_t i = 0; i < entities.size(); i++) {
+                if (!meta.at(i).sync)
+                    continue;
+                runtime.syncOut(&entities.at(i), 1);
+                stats.transitions++;
+                stats.syncBytes += sizeof(ScriptEntityData);
+            }
+        }
+    }
+
+    void invoke(ScriptRuntime &runtime, const std::string &scriptClass, size_t begin, size_t end, float deltaTime) {
+        if (batching) {
+            stats.transitions++;
+            stats.batches++;
+            if (!runtime.invokeBatch(scriptClass, entities.data() + begin, end - begin, deltaTime))
+                stats.unresolvedClasses++;
+        } else {
+            bool resolved = true;
+            for (auto i = begin; i < end; i++) {
+                stats.transitions++;
+                stats.batches++;
+                resolved = runtime.invokeBatch(scriptClass, &entities.at(i), 1, deltaTime) && resolved;
+            }
+            if (!resolved)
+                stats.unresolvedClasses++;
+        }
+    }
+
+    bool batching = true;
+
+    std::vector<ScriptEntityData> entities;
+    std::vector<Meta> meta;
+
+    std::vector<ScriptEntityData> syncEntities;
+    std::vector<size_t> syncIndices; // Index into entities of each synced entity
+
+    std::vector<ScriptEntityData> sortedEntities;
+    std::vector<Meta> sortedMeta;
+    std::unordered_map<uint64_t, size_t> bucketOf;
+    std::vector<std::pair<uint64_t, size_t>> keys; // Sort key and entity count per bucket
+    std::vector<size_t> sortedKeys;
+    std::vector<size_t> bucketOffset;
+    std::vector<size_t> entityBucket;
+
+    // Script classes are interned once, the per frame data only holds the index
+    std::unordered_map<std::string, int> classIds;
+    std::vector<std::string> classNames;
+    int lastClassId = -1;
+
+    Stats stats;
+};
+
+#endif //XSAMPLES_SCRIPTBATCH_HPP
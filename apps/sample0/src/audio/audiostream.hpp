@@ -0,0 +1,199 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_AUDIOSTREAM_HPP
+#define MANA_AUDIOSTREAM_HPP
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#include "audio/wavstream.hpp"
+
+#include "memory/allocationtracker.hpp"
+
+// Decodes a wave stream on a background thread into a fixed ring of pcm chunks.
+// The ring is single producer (the decode thread) / single consumer (the audio system),
+// the resident memory is bufferCount * chunkSize regardless of the length of the track.
+class AudioStream {
+public:
+    struct Chunk {
+        std::vector<uint8_t> data;
+        size_t size = 0;
+    };
+
+    AudioStream(std::unique_ptr<WavStream> source, size_t bufferCount, size_t chunkSize, bool loop)
+            : wav(std::move(source)),
+              ring(bufferCount < 2 ? 2 : bufferCount),
+              loop(loop) {
+        // Keep chunks aligned to whole sample frames
+        chunkSize -= chunkSize % wav->getBlockAlign();
+        if (chunkSize == 0)
+            chunkSize = wav->getBlockAlign();
+        for (auto &chunk: ring)
+            chunk.data.resize(chunkSize);
+        decodeThread = std::thread([this]() { decodeLoop(); });
+    }
+
+    ~AudioStream() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            shutdown = true;
+        }
+        wake.notify_one();
+        decodeThread.join();
+    }
+
+    AudioStream(const AudioStream &) = delete;
+
+    AudioStream &operator=(const AudioStream &) = delete;
+
+    /**
+     * @return The oldest decoded chunk or nullptr if the decoder has not caught up yet.
+     */
+    const Chunk *front() const {
+        if (readIndex.load(std::memory_order_relaxed) == writeIndex.load(std::memory_order_acquire))
+            return nullptr;
+        return &ring.at(readIndex.load(std::memory_order_relaxed) % ring.size());
+    }
+
+    // Release the chunk returned by front() back to the decoder.
+    // The mutex is never held while decoding, it only prevents a lost wakeup here.
+    void pop() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            readIndex.fetch_add(1, std::memory_order_release);
+        }
+        wake.notify_one();
+    }
+
+    // True once the end of a non looping stream was decoded and all chunks were consumed.
+    bool finished() const {
+        return endOfStream.load(std::memory_order_acquire) && front() == nullptr;
+    }
+
+    // Restart decoding at the given sample frame, discarding all pending chunks.
+    void seek(size_t frame) {
+        std::lock_guard<std::mutex> guard(mutex);
+        seekFrame = frame;
+        seekPending = true;
+        readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+        endOfStream = false;
+        wake.notify_one();
+    }
+
+    void countUnderrun() {
+        underruns++;
+    }
+
+    unsigned long getUnderruns() const {
+        return underruns;
+    }
+
+    unsigned long getDecodedChunks() const {
+        return decodedChunks;
+    }
+
+    size_t getResidentBytes() const {
+        return ring.size() * ring.front().data.size();
+    }
+
+    size_t getBufferCount() const {
+        return ring.size();
+    }
+
+    const WavStream &getSource() const {
+        return *wav;
+    }
+
+private:
+    void decodeLoop() {
+        AllocationScope scope(ALLOC_AUDIO);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this]() {
+                return shutdown
+                       || seekPending
+                       || (!endOfStream && writeIndex - readIndex < ring.size());
+            });
+
+            if (shutdown)
+                return;
+
+            if (seekPending) {
+                wav->seek(seekFrame);
+                seekPending = false;
+            }
+
+            // The consumer only touches readIndex and chunks below writeIndex,
+            // so the slot at writeIndex can be filled without holding the lock.
+            auto &chunk = ring.at(writeIndex.load(std::memory_order_relaxed) % ring.size());
+            lock.unlock();
+            chunk.size = fill(chunk.data);
+            lock.lock();
+
+            if (seekPending)
+                continue; // Discard the chunk, it belongs to the previous position
+
+            if (chunk.size > 0) {
+                writeIndex.fetch_add(1, std::memory_order_release);
+                decodedChunks++;
+            } else {
+                endOfStream = true;
+            }
+        }
+    }
+
+    size_t fill(std::vector<uint8_t> &buffer) {
+        size_t size = 0;
+        while (size < buffer.size()) {
+            auto count = wav->read(buffer.data() + size, buffer.size() - size);
+            if (count == 0) {
+                if (!loop || wav->getFrameCount() == 0)
+                    break;
+                wav->rewind();
+            }
+            size += count;
+        }
+        return size;
+    }
+
+    std::unique_ptr<WavStream> wav;
+    std::vector<Chunk> ring;
+    bool loop;
+
+    std::atomic<size_t> readIndex{0};
+    std::atomic<size_t> writeIndex{0};
+    std::atomic<bool> endOfStream{false};
+
+    std::atomic<unsigned long> underruns{0};
+    std::atomic<unsigned long> decodedChunks{0};
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool shutdown = false;
+    bool seekPending = false;
+    size_t seekFrame = 0;
+
+    std::thread decodeThread;
+};
+
+#endif //MANA_AUDIOSTREAM_HPP
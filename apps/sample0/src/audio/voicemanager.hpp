@@ -0,0 +1,125 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_VOICEMANAGER_HPP
+#define MANA_VOICEMANAGER_HPP
+
+#include <vector>
+#include <algorithm>
+
+// Decides which audio emitters get one of the limited device voices.
+// Emitters are ranked by priority and then by their audibility at the listener,
+// everything outside the voice budget or below the audibility threshold is virtualized,
+// virtual emitters only keep their playback clock and do not hold any device resources.
+class VoiceManager {
+public:
+    struct Candidate {
+        float distance = 0; // The distance to the listener
+        float volume = 1;
+        int priority = 0; // Higher values are preferred regardless of audibility
+        bool active = false; // In: whether the emitter currently holds a voice, Out: whether it should hold one
+
+        float audibility = 0;
+    };
+
+    void setMaxVoices(size_t value) {
+        maxVoices = value;
+    }
+
+    size_t getMaxVoices() const {
+        return maxVoices;
+    }
+
+    void setMaxDistance(float value) {
+        maxDistance = value;
+    }
+
+    void setReferenceDistance(float value) {
+        referenceDistance = value;
+    }
+
+    void setAudibilityThreshold(float value) {
+        audibilityThreshold = value;
+    }
+
+    // Inverse distance clamped attenuation, matches the default distance model of the audio device.
+    float getAttenuation(float distance) const {
+        if (distance <= referenceDistance)
+            return 1;
+        return referenceDistance / distance;
+    }
+
+    void update(std::vector<Candidate> &candidates) {
+        order.clear();
+
+        for (size_t i = 0; i < candidates.size(); i++) {
+            auto &candidate = candidates.at(i);
+            candidate.audibility = candidate.volume * getAttenuation(candidate.distance);
+
+            // Favor voices which are already playing so that emitters close in audibility do not flip every frame
+            if (candidate.active)
+                candidate.audibility *= hysteresis;
+
+            candidate.active = false;
+            if (candidate.distance <= maxDistance && candidate.audibility >= audibilityThreshold)
+                order.emplace_back(i);
+        }
+
+        auto compare = [&candidates](size_t a, size_t b) {
+            auto &ca = candidates.at(a);
+            auto &cb = candidates.at(b);
+            if (ca.priority != cb.priority)
+                return ca.priority > cb.priority;
+            return ca.audibility > cb.audibility;
+        };
+
+        if (order.size() > maxVoices) {
+            std::nth_element(order.begin(), order.begin() + maxVoices, order.end(), compare);
+            order.resize(maxVoices);
+        }
+
+        for (auto index: order)
+            candidates.at(index).active = true;
+
+        activeVoices = order.size();
+        virtualVoices = candidates.size() - order.size();
+    }
+
+    size_t getActiveVoices() const {
+        return activeVoices;
+    }
+
+    size_t getVirtualVoices() const {
+        return virtualVoices;
+    }
+
+private:
+    size_t maxVoices = 32;
+    float maxDistance = 500;
+    float referenceDistance = 1;
+    float audibilityThreshold = 0.001f;
+    float hysteresis = 1.1f;
+
+    size_t activeVoices = 0;
+    size_t virtualVoices = 0;
+
+    std::vector<size_t> order;
+};
+
+#endif //MANA_VOICEMANAGER_HPP
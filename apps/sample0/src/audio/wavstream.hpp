@@ -0,0 +1,181 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_WAVSTREAM_HPP
+#define MANA_WAVSTREAM_HPP
+
+#include <algorithm>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+#include "platform/byteorder.hpp"
+
+// Incremental reader for uncompressed PCM wave files.
+// Only the header is parsed on construction, the sample data is read on demand
+// so that the memory usage does not depend on the length of the file.
+class WavStream {
+public:
+    explicit WavStream(std::unique_ptr<std::istream> source)
+            : stream(std::move(source)) {
+        if (!stream || !*stream)
+            throw std::runtime_error("Invalid wave stream");
+
+        char riff[12];
+        readExact(riff, sizeof(riff));
+        if (std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0)
+            throw std::runtime_error("Not a RIFF/WAVE stream");
+
+        bool haveFormat = false;
+        while (true) {
+            char chunkId[4];
+            readExact(chunkId, sizeof(chunkId));
+            uint32_t chunkSize = readU32();
+
+            if (std::memcmp(chunkId, "fmt ", 4) == 0) {
+                if (chunkSize < 16)
+                    throw std::runtime_error("Invalid wave format chunk");
+                uint16_t audioFormat = readU16();
+                channels = readU16();
+                sampleRate = readU32();
+                readU32(); // Byte rate
+                blockAlign = readU16();
+                bitsPerSample = readU16();
+
+                if (audioFormat != 1)
+                    throw std::runtime_error("Only PCM wave files can be streamed");
+                if (channels < 1 || channels > 2 || (bitsPerSample != 8 && bitsPerSample != 16))
+                    throw std::runtime_error("Unsupported wave sample layout");
+
+                skip(chunkSize - 16);
+                haveFormat = true;
+            } else if (std::memcmp(chunkId, "data", 4) == 0) {
+                if (!haveFormat)
+                    throw std::runtime_error("Wave data chunk before format chunk");
+                dataOffset = stream->tellg();
+                dataSize = chunkSize;
+                break;
+            } else {
+                skip(chunkSize);
+            }
+
+            // Chunks are padded to an even size
+            if (chunkSize % 2 != 0)
+                skip(1);
+        }
+    }
+
+    /**
+     * Read up to size bytes of sample data into buffer.
+     * The returned byte count is always a multiple of the block alignment.
+     *
+     * @return The number of bytes read, 0 if the end of the data chunk was reached.
+     */
+    size_t read(uint8_t *buffer, size_t size) {
+        size_t remaining = dataSize - readOffset;
+        size_t count = std::min(size, remaining);
+        count -= count % blockAlign;
+        if (count == 0)
+            return 0;
+
+        stream->read(reinterpret_cast<char *>(buffer), static_cast<std::streamsize>(count));
+        count = static_cast<size_t>(stream->gcount());
+        readOffset += count;
+        return count;
+    }
+
+    /**
+     * Move the read position to the given sample frame, clamped to the end of the data.
+     */
+    void seek(size_t frame) {
+        readOffset = std::min(frame * blockAlign, dataSize - dataSize % blockAlign);
+        stream->clear();
+        stream->seekg(dataOffset + static_cast<std::streamoff>(readOffset));
+    }
+
+    void rewind() {
+        seek(0);
+    }
+
+    bool eof() const {
+        return dataSize - readOffset < blockAlign;
+    }
+
+    int getChannels() const {
+        return channels;
+    }
+
+    int getSampleRate() const {
+        return static_cast<int>(sampleRate);
+    }
+
+    int getBitsPerSample() const {
+        return bitsPerSample;
+    }
+
+    int getBlockAlign() const {
+        return blockAlign;
+    }
+
+    size_t getFrameCount() const {
+        return dataSize / blockAlign;
+    }
+
+    size_t getFramePosition() const {
+        return readOffset / blockAlign;
+    }
+
+private:
+    void readExact(char *buffer, size_t size) {
+        stream->read(buffer, static_cast<std::streamsize>(size));
+        if (static_cast<size_t>(stream->gcount()) != size)
+            throw std::runtime_error("Unexpected end of wave stream");
+    }
+
+    uint16_t readU16() {
+        char b[2];
+        readExact(b, sizeof(b));
+        return ::readU16(b);
+    }
+
+    uint32_t readU32() {
+        char b[4];
+        readExact(b, sizeof(b));
+        return ::readU32(b);
+    }
+
+    void skip(size_t size) {
+        stream->seekg(static_cast<std::streamoff>(size), std::ios::cur);
+    }
+
+    std::unique_ptr<std::istream> stream;
+
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint16_t blockAlign = 1;
+    uint16_t bitsPerSample = 0;
+
+    std::streampos dataOffset = 0;
+    size_t dataSize = 0;
+    size_t readOffset = 0;
+};
+
+#endif //MANA_WAVSTREAM_HPP
@@ -0,0 +1,37 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_STREAMINGAUDIOSOURCECOMPONENT_HPP
+#define MANA_STREAMINGAUDIOSOURCECOMPONENT_HPP
+
+#include <string>
+
+// An audio source which is decoded incrementally from the archive instead of being loaded as a whole,
+// used for long tracks such as music.
+struct StreamingAudioSourceComponent {
+    std::string path; // The archive path of the wave file
+    bool play = false;
+    bool loop = false;
+    float volume = 1;
+    int priority = 0; // Sources with a higher priority keep their voice over more audible ones
+    int bufferCount = 4; // The number of device buffers in flight, higher values trade latency for underrun safety
+    size_t chunkSize = 16384; // The size of each buffer in bytes
+};
+
+#endif //MANA_STREAMINGAUDIOSOURCECOMPONENT_HPP
@@ -21,6 +21,8 @@
 #define MANA_DEBUGWINDOW_HPP
 
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 
 #include "imgui.h"
 #include "implot.h"
@@ -29,11 +31,28 @@
 
 #include "gui/stringformat.hpp"
 
+#include "profiling/latencytracker.hpp"
+#include "profiling/startupprofiler.hpp"
+
+#include "platform/cpufeatures.hpp"
+
+#include "memory/framearena.hpp"
+#include "memory/allocationtracker.hpp"
+
+#include "render/lightclusters.hpp"
+#include "render/glyphatlas.hpp"
+#include "render/spritequeue.hpp"
+#include "render/occlusionculler.hpp"
+#include "render/texturestreamer.hpp"
+
+#include "scripting/scriptbatch.hpp"
+
 class DebugWindow {
 public:
     void drawFrameTimeGraph() {
         if (ImPlot::BeginPlot("Frame Graph")) {
-            std::vector<float> x;
+            ArenaVector<float> x;
+            x.reserve(frameRateHistory.size());
             for (int i = 0; i < frameRateHistory.size(); i++)
                 x.emplace_back(i);
 
@@ -48,6 +67,81 @@ public:
         }
     }
 
+    void drawLatencyGraph() {
+        ImGui::Text("Input to present (ms): p50 %.2f p95 %.2f p99 %.2f max %.2f (%ld samples)",
+                    latency.p50,
+                    latency.p95,
+                    latency.p99,
+                    latency.max,
+                    latency.samples);
+
+        if (latencyHistory == nullptr || latencyHistory->empty())
+            return;
+
+        if (ImPlot::BeginPlot("Input Latency")) {
+            latencyX.resize(latencyHistory->size());
+            for (size_t i = 0; i < latencyX.size(); i++)
+                latencyX[i] = static_cast<float>(i);
+
+            ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 100);
+            ImPlot::SetupAxisLimits(::ImAxis_X1, 0, static_cast<double>(latencyX.size()));
+
+            ImPlot::PlotLine("Input to Present (ms)", latencyX.data(), latencyHistory->data(), latencyHistory->size());
+
+            ImPlot::EndPlot();
+        }
+    }
+
+    void drawMemoryTab() {
+        if (!AllocationTracker::isEnabled()) {
+            ImGui::Text("Allocation tracking is disabled, configure with -DXSAMPLES_ALLOCATION_TRACKING=ON");
+            return;
+        }
+
+        for (int i = 0; i < ALLOC_TAG_COUNT; i++) {
+            auto &tag = allocationSnapshot.tags[i];
+            ImGui::Text("%-10s live %10.2f KiB  peak %10.2f KiB  %6.0f allocations/frame",
+                        getAllocationTagName(static_cast<AllocationTag>(i)),
+                        (double) tag.liveBytes / 1024.0,
+                        (double) tag.peakBytes / 1024.0,
+                        allocationRateHistory[i].empty() ? 0.0 : (double) allocationRateHistory[i].back());
+        }
+
+        if (ImGui::Button("Dump Snapshot")) {
+            std::string fileName = "memory-snapshot-" + std::to_string(snapshotIndex++) + ".json";
+            std::ofstream fs(fileName);
+            allocationSnapshot.write(fs);
+        }
+
+        if (allocationRateHistory[0].empty())
+            return;
+
+        ArenaVector<float> x;
+        x.reserve(allocationRateHistory[0].size());
+        for (size_t i = 0; i < allocationRateHistory[0].size(); i++)
+            x.emplace_back(i);
+
+        if (ImPlot::BeginPlot("Live Memory (KiB)")) {
+            for (int i = 0; i < ALLOC_TAG_COUNT; i++) {
+                ImPlot::PlotLine(getAllocationTagName(static_cast<AllocationTag>(i)),
+                                 x.data(),
+                                 liveMemoryHistory[i].data(),
+                                 liveMemoryHistory[i].size());
+            }
+            ImPlot::EndPlot();
+        }
+
+        if (ImPlot::BeginPlot("Allocations per Frame")) {
+            for (int i = 0; i < ALLOC_TAG_COUNT; i++) {
+                ImPlot::PlotLine(getAllocationTagName(static_cast<AllocationTag>(i)),
+                                 x.data(),
+                                 allocationRateHistory[i].data(),
+                                 allocationRateHistory[i].size());
+            }
+            ImPlot::EndPlot();
+        }
+    }
+
     void draw() {
         frameRateHistory.emplace(frameRateHistory.begin(), ImGui::GetIO().Framerate);
         if (frameRateHistory.size() >= 10000)
@@ -69,18 +163,16 @@ public:
 
         if (ImGui::BeginTabItem("Settings")) {
             if (ImGui::TreeNode("Window")) {
-                std::vector<std::string> modes;
-                std::vector<const char *> cModeStr;
+                // The labels only live until the end of the frame and are placed in the frame arena
+                auto &arena = FrameArena::getThreadArena();
+                ArenaVector<const char *> cModeStr;
+                cModeStr.reserve(videoModes.size());
                 for (auto &mode: videoModes) {
-                    std::string str = std::to_string(mode.width);
-                    str += "x";
-                    str += std::to_string(mode.height);
-                    str += "@";
-                    str += std::to_string(mode.refreshRate);
-                    str += "            "; // ImGui::ListBox seems to be bugged the items need to have a minimum length otherwise random chars are displayed
-
-                    modes.emplace_back(str);
-                    cModeStr.emplace_back((modes.end() - 1)->c_str());
+                    const size_t labelSize = 64;
+                    auto *str = arena.allocate<char>(labelSize);
+                    // ImGui::ListBox seems to be bugged the items need to have a minimum length otherwise random chars are displayed
+                    std::snprintf(str, labelSize, "%dx%d@%d            ", mode.width, mode.height, mode.refreshRate);
+                    cModeStr.emplace_back(str);
                 }
 
                 ImGui::ListBox("",
@@ -109,6 +201,9 @@ public:
                 ImGui::InputInt2("Render Resolution", res, ImGuiInputTextFlags_ReadOnly);
 
                 ImGui::SliderFloat("Resolution Scale", &resScale, 0.1, 3, "%.1f");
+                // Apply the scale once the slider is released instead of reallocating the targets on every step
+                if (!ImGui::IsItemActive())
+                    appliedResScale = resScale;
 
                 ImGui::InputInt("MSAA Samples", &samples);
                 if (samples > maxSamples)
@@ -126,11 +221,137 @@ public:
                 ImGui::TreePop();
             }
 
+            if (ImGui::TreeNode("Audio")) {
+                ImGui::InputInt("Max Voices", &maxVoices);
+                if (maxVoices < 0)
+                    maxVoices = 0;
+                ImGui::TreePop();
+            }
+
             ImGui::EndTabItem();
         }
 
         if (ImGui::BeginTabItem("Profiling")) {
             drawFrameTimeGraph();
+            ImGui::Text("CPU dispatch level: %s", getCpuLevelName(getCpuLevel()));
+            if (ImGui::TreeNode("Startup")) {
+                if (startupPhases != nullptr) {
+                    for (auto &phase: *startupPhases)
+                        ImGui::Text("%s: %.1f ms", phase.name.c_str(), phase.time);
+                }
+                ImGui::Text("Total: %.1f ms", startupTotal);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Frame Arena")) {
+                ImGui::Text("Allocations: %ld", arenaStats.allocations);
+                ImGui::Text("Bytes: %.1f KiB", (double) arenaStats.bytes / 1024.0);
+                ImGui::Text("Capacity: %.1f KiB", (double) arenaStats.capacity / 1024.0);
+                ImGui::Text("Heap allocations: %ld", arenaStats.heapAllocations);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Frame Graph")) {
+                ImGui::Checkbox("Skybox pass", &skyboxPass);
+                ImGui::Text("Passes: %ld / %ld", frameGraphPasses, frameGraphTotalPasses);
+                // The pipeline allocates its own targets, the planner only estimates them from the pixel formats
+                ImGui::Text("Estimated render targets: %.2f MiB", (double) frameGraphTargetBytes / (1024.0 * 1024.0));
+                ImGui::Text("Reconfigurations: %ld", pipelineReconfigurations);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Light Clusters")) {
+                ImGui::Checkbox("Enabled", &lightClustering);
+                ImGui::Text("Clustered lights: %ld (%ld visible), directional lights: %ld",
+                            lightClusterStats.lights,
+                            lightClusterStats.visibleLights,
+                            directionalLights);
+                ImGui::Text("Occupied clusters: %ld / %ld", lightClusterStats.occupiedClusters, lightClusters);
+                ImGui::Text("Lights per occupied cluster: %.2f average, %ld max",
+                            lightClusterStats.occupiedClusters == 0
+                            ? 0.0
+                            : (double) lightClusterStats.indices / (double) lightClusterStats.occupiedClusters,
+                            lightClusterStats.maxLightsPerCluster);
+                ImGui::Text("Build time: %.3f ms", lightClusterBuildTime);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Occlusion Culling")) {
+                ImGui::Checkbox("Enabled", &occlusionCulling);
+                ImGui::Text("Occluders: %ld (%ld triangles)",
+                            occlusionStats.occluders,
+                            occlusionStats.occluderTriangles);
+                ImGui::Text("Occluded: %ld / %ld tested, %ld parked",
+                            occlusionStats.occluded,
+                            occlusionStats.tested,
+                            occludedParked);
+                ImGui::Text("Raster: %.3f ms Test: %.3f ms Wait: %.3f ms",
+                            occlusionStats.rasterTime,
+                            occlusionStats.testTime,
+                            occlusionWaitTime);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Texture Streaming")) {
+                if (textureStats.textures == 0)
+                    ImGui::Text("No streamed textures, start with --texture-streaming to enable the streamer");
+                ImGui::SliderInt("Budget (MiB)", &textureBudget, 8, 512);
+                ImGui::Text("Resident: %.2f / %.2f MiB (%.2f MiB wanted)",
+                            (double) textureStats.residentBytes / (1024.0 * 1024.0),
+                            (double) textureStats.budgetBytes / (1024.0 * 1024.0),
+                            (double) textureStats.wantedBytes / (1024.0 * 1024.0));
+                ImGui::Text("Textures: %ld (%ld below the requested mip)",
+                            textureStats.textures,
+                            textureStats.starvedTextures);
+                ImGui::Text("Loads: %ld pending, %ld completed, %ld failed",
+                            textureStats.pendingLoads,
+                            textureStats.loads,
+                            textureStats.failedLoads);
+                ImGui::Text("Evicted levels: %ld Streamed: %.2f MiB Load: %.3f ms",
+                            textureStats.evictedLevels,
+                            (double) textureStats.streamedBytes / (1024.0 * 1024.0),
+                            textureStats.loadTime);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Text")) {
+                ImGui::Text("Glyph atlas: %ld / %ld cells", glyphAtlasStats.resident, glyphAtlasStats.capacity);
+                ImGui::Text("Hits: %ld Misses: %ld Evictions: %ld Failures: %ld",
+                            glyphAtlasStats.hits,
+                            glyphAtlasStats.misses,
+                            glyphAtlasStats.evictions,
+                            glyphAtlasStats.failures);
+                ImGui::Text("Atlas uploads: %ld", glyphAtlasUploads);
+                ImGui::Text("Sprites: %ld Batches: %ld (%ld unsorted)",
+                            spriteStats.sprites,
+                            spriteStats.batches,
+                            spriteStats.unsortedBatches);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Scripting")) {
+                ImGui::Checkbox("Batch script calls", &scriptBatching);
+                ImGui::Text("Scripted entities: %ld Synced entities: %ld",
+                            scriptStats.scriptedEntities,
+                            scriptStats.syncedEntities);
+                ImGui::Text("Transitions: %ld (%ld unbatched) Batches: %ld",
+                            scriptStats.transitions,
+                            scriptStats.unbatchedTransitions,
+                            scriptStats.batches);
+                ImGui::Text("Sync: %.1f KiB", (double) scriptStats.syncBytes / 1024.0);
+                ImGui::Text("Unresolved classes: %ld", scriptStats.unresolvedClasses);
+                ImGui::Text("Bridge time: %.3f ms", scriptBridgeTime);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Input Latency")) {
+                drawLatencyGraph();
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Audio")) {
+                ImGui::Text("Active voices: %ld", activeVoices);
+                ImGui::Text("Virtual voices: %ld", virtualVoices);
+                ImGui::Text("Resident decode buffers: %.1f KiB", (double) audioStreamBytes / 1024.0);
+                ImGui::Text("Underruns: %ld", audioUnderruns);
+                ImGui::TreePop();
+            }
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem("Memory")) {
+            drawMemoryTab();
             ImGui::EndTabItem();
         }
 
@@ -191,14 +412,118 @@ public:
         polyCount = value;
     }
 
+    void setVoiceCount(size_t active, size_t virtualCount) {
+        activeVoices = active;
+        virtualVoices = virtualCount;
+    }
+
+    int getMaxVoices() const {
+        return maxVoices;
+    }
+
+    void setAudioStreamStats(size_t residentBytes, unsigned long underruns) {
+        audioStreamBytes = residentBytes;
+        audioUnderruns = underruns;
+    }
+
+    void setLatency(const std::vector<float> &history, const LatencyTracker::Distribution &distribution) {
+        latencyHistory = &history;
+        latency = distribution;
+    }
+
+    void setArenaStats(const FrameArena::Stats &value) {
+        arenaStats = value;
+    }
+
+    void setAllocationSnapshot(const AllocationTracker::Snapshot &value) {
+        for (int i = 0; i < ALLOC_TAG_COUNT; i++) {
+            auto allocations = value.tags[i].allocations - allocationSnapshot.tags[i].allocations;
+            pushHistory(allocationRateHistory[i], (float) allocations);
+            pushHistory(liveMemoryHistory[i], (float) ((double) value.tags[i].liveBytes / 1024.0));
+        }
+        allocationSnapshot = value;
+    }
+
+    void setFrameGraphStats(size_t passes,
+                            size_t totalPasses,
+                            size_t targetBytes,
+                            unsigned long reconfigurations) {
+        frameGraphPasses = passes;
+        frameGraphTotalPasses = totalPasses;
+        frameGraphTargetBytes = targetBytes;
+        pipelineReconfigurations = reconfigurations;
+    }
+
+    void setLightClusterStats(const LightClusterGrid::Stats &stats,
+                              size_t clusters,
+                              size_t directional,
+                              float buildTime) {
+        lightClusterStats = stats;
+        lightClusters = clusters;
+        directionalLights = directional;
+        lightClusterBuildTime = buildTime;
+    }
+
+    void setStartupPhases(const std::vector<StartupProfiler::Phase> &phases, float total) {
+        startupPhases = &phases;
+        startupTotal = total;
+    }
+
+    void setTextStats(const GlyphAtlas::Stats &stats, unsigned long uploads) {
+        glyphAtlasStats = stats;
+        glyphAtlasUploads = uploads;
+    }
+
+    void setSpriteStats(const SpriteQueueStats &stats) {
+        spriteStats = stats;
+    }
+
+    void setOcclusionStats(const OcclusionCuller::Stats &stats, size_t parked, float waitTime) {
+        occlusionStats = stats;
+        occludedParked = parked;
+        occlusionWaitTime = waitTime;
+    }
+
+    bool getOcclusionCulling() const {
+        return occlusionCulling;
+    }
+
+    void setTextureStreamingStats(const TextureStreamer::Stats &stats) {
+        textureStats = stats;
+    }
+
+    /**
+     * @return The texture streaming budget in bytes
+     */
+    size_t getTextureBudget() const {
+        return static_cast<size_t>(textureBudget) * 1024 * 1024;
+    }
+
+    void setScriptStats(const ScriptBatcher::Stats &stats, float bridgeTime) {
+        scriptStats = stats;
+        scriptBridgeTime = bridgeTime;
+    }
+
+    bool getScriptBatching() const {
+        return scriptBatching;
+    }
+
+    bool getLightClustering() const {
+        return lightClustering;
+    }
+
+    bool getSkyboxPass() const {
+        return skyboxPass;
+    }
+
     void setFrameBufferSize(Vec2i size) {
         frameBufferSize = size;
     }
 
     Vec2i getRenderResolution() const {
         Vec2i ret;
-        ret.x = (int) ((float) frameBufferSize.x * resScale);
-        ret.y = (int) ((float) frameBufferSize.y * resScale);
+        ret.x = (int) ((float) frameBufferSize.x * appliedResScale);
+        ret.y = (int) ((float) frameBufferSize.y * appliedResScale);
         return ret;
     }
 
@@ -223,13 +548,25 @@ public:
     }
 
 private:
+    static void pushHistory(std::vector<float> &history, float value) {
+        if (history.size() >= 1000)
+            history.erase(history.begin());
+        history.emplace_back(value);
+    }
+
     int maxSamples = 0;
     int samples = 0;
     int swapInterval = 0;
     unsigned long drawCalls = 0;
     float fpsLimit = 0;
     size_t polyCount = 0;
+    int maxVoices = 32;
+    size_t activeVoices = 0;
+    size_t virtualVoices = 0;
+    size_t audioStreamBytes = 0;
+    unsigned long audioUnderruns = 0;
     float resScale = 1;
+    float appliedResScale = 1;
     Vec2i frameBufferSize = {};
     Camera camera;
     std::vector<VideoMode> videoModes;
@@ -240,6 +577,48 @@ private:
     std::vector<float> frameRateHistory;
     std::vector<float> frameTimeHistory;
     std::vector<float> drawCallHistory;
+
+    const std::vector<float> *latencyHistory = nullptr;
+    std::vector<float> latencyX;
+    LatencyTracker::Distribution latency;
+
+    FrameArena::Stats arenaStats;
+
+    const std::vector<StartupProfiler::Phase> *startupPhases = nullptr;
+    float startupTotal = 0;
+
+    GlyphAtlas::Stats glyphAtlasStats;
+    unsigned long glyphAtlasUploads = 0;
+    SpriteQueueStats spriteStats;
+
+    OcclusionCuller::Stats occlusionStats;
+    size_t occludedParked = 0;
+    float occlusionWaitTime = 0;
+    bool occlusionCulling = true;
+
+    TextureStreamer::Stats textureStats;
+    int textureBudget = 64;
+
+    ScriptBatcher::Stats scriptStats;
+    float scriptBridgeTime = 0;
+    bool scriptBatching = true;
+
+    LightClusterGrid::Stats lightClusterStats;
+    size_t lightClusters = 0;
+    size_t directionalLights = 0;
+    float lightClusterBuildTime = 0;
+    bool lightClustering = false;
+
+    size_t frameGraphPasses = 0;
+    size_t frameGraphTotalPasses = 0;
+    size_t frameGraphTargetBytes = 0;
+    bool skyboxPass = true;
+    unsigned long pipelineReconfigurations = 0;
+
+    AllocationTracker::Snapshot allocationSnapshot;
+    std::vector<float> allocationRateHistory[ALLOC_TAG_COUNT];
+    std::vector<float> liveMemoryHistory[ALLOC_TAG_COUNT];
+    int snapshotIndex = 0;
 };
 
 #endif //MANA_DEBUGWINDOW_HPP
@@ -0,0 +1,168 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_ACTIONMAPPER_HPP
+#define MANA_ACTIONMAPPER_HPP
+
+#include <vector>
+
+#include "math/normalize.hpp"
+
+#include "input/inputeventqueue.hpp"
+
+using namespace xengine;
+
+// The resolved input state of a frame which the systems consume instead of querying the devices.
+struct InputActions {
+    Vec3f movement; // Normalized, x = left, y = up, z = forward
+    Vec3f rotation; // Normalized, x = pitch, y = yaw
+    bool boost = false;
+};
+
+// Maps the key events from the InputEventQueue and the gamepad axes to InputActions,
+// the mapping is resolved once per frame.
+class ActionMapper {
+public:
+    enum Action {
+        MOVE_X,
+        MOVE_Y,
+        MOVE_Z,
+        LOOK_X,
+        LOOK_Y,
+        BOOST
+    };
+
+    ActionMapper() {
+        bind(KEY_W, MOVE_Z, 1);
+        bind(KEY_S, MOVE_Z, -1);
+        bind(KEY_A, MOVE_X, 1);
+        bind(KEY_D, MOVE_X, -1);
+        bind(KEY_E, MOVE_Y, 1);
+        bind(KEY_Q, MOVE_Y, -1);
+        bind(KEY_UP, LOOK_X, 1);
+        bind(KEY_DOWN, LOOK_X, -1);
+        bind(KEY_LEFT, LOOK_Y, -1);
+        bind(KEY_RIGHT, LOOK_Y, 1);
+        bind(KEY_LSHIFT, BOOST, 1);
+    }
+
+    // Keys bound to the same action do not add up, the first held key in binding order sets the action.
+    void bind(KeyboardKey key, Action action, float scale) {
+        bindings.emplace_back(Binding{key, action, scale, false});
+    }
+
+    void clearBindings() {
+        bindings.clear();
+    }
+
+    void setStickDeadZone(float value) {
+        deadzone = value;
+    }
+
+    /**
+     * Drain the queued events and compute the actions for this frame.
+     * The gamepads do not generate events and are sampled here by reference.
+     */
+    const InputActions &resolve(InputEventQueue &queue, const Input &input) {
+        InputEvent event;
+        eventCount = 0;
+        while (queue.pop(event)) {
+            if (eventCount++ == 0)
+                oldestEventTime = event.time;
+            if (event.type != InputEvent::KEY_DOWN && event.type != InputEvent::KEY_UP)
+                continue;
+            for (auto &binding: bindings) {
+                if (binding.key == event.key)
+                    binding.held = event.type == InputEvent::KEY_DOWN;
+            }
+        }
+
+        float axes[BOOST + 1] = {};
+        bool pressed[BOOST + 1] = {};
+        for (auto &binding: bindings) {
+            if (binding.held && !pressed[binding.action]) {
+                axes[binding.action] = binding.scale;
+                pressed[binding.action] = true;
+            }
+        }
+
+        for (auto &pad: input.getGamePads()) {
+            axes[MOVE_X] += applyDeadzone(pad.second.getGamepadAxis(LEFT_X) * -1);
+            axes[MOVE_Z] += applyDeadzone(pad.second.getGamepadAxis(LEFT_Y) * -1);
+            if (pad.second.getGamepadButton(BUMPER_LEFT)) {
+                axes[MOVE_Y] = -1;
+            } else if (pad.second.getGamepadButton(BUMPER_RIGHT)) {
+                axes[MOVE_Y] = 1;
+            }
+            axes[LOOK_X] += applyDeadzone(pad.second.getGamepadAxis(RIGHT_Y) * -1);
+            axes[LOOK_Y] += applyDeadzone(pad.second.getGamepadAxis(RIGHT_X));
+        }
+
+        actions.movement = normalize(Vec3f(axes[MOVE_X], axes[MOVE_Y], axes[MOVE_Z]));
+        actions.rotation = normalize(Vec3f(axes[LOOK_X], axes[LOOK_Y], 0));
+        actions.boost = axes[BOOST] > 0;
+
+        return actions;
+    }
+
+    const InputActions &getActions() const {
+        return actions;
+    }
+
+    // Replace the resolved actions of this frame, used to replay recorded input
+    void setActions(const InputActions &value) {
+        actions = value;
+    }
+
+    // The number of events drained by the last call to resolve
+    size_t getEventCount() const {
+        return eventCount;
+    }
+
+    // The timestamp of the first event drained by the last call to resolve, only valid if getEventCount() > 0
+    std::chrono::steady_clock::time_point getOldestEventTime() const {
+        return oldestEventTime;
+    }
+
+private:
+    struct Binding {
+        KeyboardKey key;
+        Action action;
+        float scale;
+        bool held;
+    };
+
+    float applyDeadzone(float value) const {
+        if (value < deadzone && value > -deadzone) {
+            return 0;
+        } else {
+            return value;
+        }
+    }
+
+    std::vector<Binding> bindings;
+    float deadzone = 0.1f;
+
+    InputActions actions;
+
+    size_t eventCount = 0;
+    std::chrono::steady_clock::time_point oldestEventTime;
+};
+
+#endif //MANA_ACTIONMAPPER_HPP
@@ -0,0 +1,118 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_INPUTEVENTQUEUE_HPP
+#define MANA_INPUTEVENTQUEUE_HPP
+
+#include <atomic>
+#include <array>
+#include <chrono>
+
+#include "xengine.hpp"
+
+using namespace xengine;
+
+struct InputEvent {
+    enum Type {
+        KEY_DOWN,
+        KEY_UP,
+        MOUSE_MOVE,
+        MOUSE_WHEEL
+    };
+
+    Type type = KEY_DOWN;
+    std::chrono::steady_clock::time_point time;
+    KeyboardKey key{};
+    Vec2d value; // Cursor position for MOUSE_MOVE, scroll amount in x for MOUSE_WHEEL
+};
+
+// Lock free single producer / single consumer queue of timestamped input events.
+// The producer is the thread dispatching the window events, the consumer drains the queue once per frame.
+class InputEventQueue : public InputListener {
+public:
+    static const size_t CAPACITY = 1024;
+
+    /**
+     * Pop the oldest event.
+     *
+     * @return False if the queue is empty.
+     */
+    bool pop(InputEvent &event) {
+        auto read = readIndex.load(std::memory_order_relaxed);
+        if (read == writeIndex.load(std::memory_order_acquire))
+            return false;
+        event = events[read % CAPACITY];
+        readIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    // The number of events which were discarded because the consumer did not keep up.
+    unsigned long getDroppedEvents() const {
+        return droppedEvents.load(std::memory_order_relaxed);
+    }
+
+    void onKeyDown(KeyboardKey key) override {
+        InputEvent event;
+        event.type = InputEvent::KEY_DOWN;
+        event.key = key;
+        push(event);
+    }
+
+    void onKeyUp(KeyboardKey key) override {
+        InputEvent event;
+        event.type = InputEvent::KEY_UP;
+        event.key = key;
+        push(event);
+    }
+
+    void onMouseMove(double xPos, double yPos) override {
+        InputEvent event;
+        event.type = InputEvent::MOUSE_MOVE;
+        event.value = {xPos, yPos};
+        push(event);
+    }
+
+    void onMouseWheelScroll(double amount) override {
+        InputEvent event;
+        event.type = InputEvent::MOUSE_WHEEL;
+        event.value = {amount, 0};
+        push(event);
+    }
+
+private:
+    void push(InputEvent &event) {
+        event.time = std::chrono::steady_clock::now();
+
+        auto write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) >= CAPACITY) {
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[write % CAPACITY] = event;
+        writeIndex.store(write + 1, std::memory_order_release);
+    }
+
+    std::array<InputEvent, CAPACITY> events{};
+
+    alignas(64) std::atomic<size_t> readIndex{0};
+    alignas(64) std::atomic<size_t> writeIndex{0};
+    std::atomic<unsigned long> droppedEvents{0};
+};
+
+#endif //MANA_INPUTEVENTQUEUE_HPP
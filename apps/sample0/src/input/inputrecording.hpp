@@ -0,0 +1,178 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_INPUTRECORDING_HPP
+#define MANA_INPUTRECORDING_HPP
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+#include "input/actionmapper.hpp"
+
+#include "platform/byteorder.hpp"
+
+// Binary log of the resolved InputActions and the deltaTime of every frame.
+// A frame is a flags byte and the deltaTime, followed by the actions only if they changed since
+// the previous frame, so a frame without input changes costs 5 bytes.
+// Recording after the ActionMapper makes the log independent of the bindings and the connected devices.
+class InputRecorder {
+public:
+    static constexpr char MAGIC[4] = {'X', 'S', 'I', 'R'};
+    static const uint32_t VERSION = 1;
+
+    enum FrameFlags : uint8_t {
+        FRAME_ACTIONS = 1 << 0, // Five floats follow: movement xyz, rotation xy
+        FRAME_BOOST = 1 << 1 // Only valid together with FRAME_ACTIONS
+    };
+
+    explicit InputRecorder(std::ostream &stream)
+            : stream(stream) {
+        stream.write(InputRecorder::MAGIC, sizeof(InputRecorder::MAGIC));
+        writeU32(InputRecorder::VERSION);
+    }
+
+    void record(float deltaTime, const InputActions &actions) {
+        uint8_t flags = 0;
+        if (frames == 0 || !equals(actions, previous)) {
+            flags |= InputRecorder::FRAME_ACTIONS;
+            if (actions.boost)
+                flags |= InputRecorder::FRAME_BOOST;
+        }
+
+        stream.put(static_cast<char>(flags));
+        writeF32(deltaTime);
+        if (flags & InputRecorder::FRAME_ACTIONS) {
+            writeF32(actions.movement.x);
+            writeF32(actions.movement.y);
+            writeF32(actions.movement.z);
+            writeF32(actions.rotation.x);
+            writeF32(actions.rotation.y);
+        }
+
+        previous = actions;
+        frames++;
+    }
+
+    void flush() {
+        stream.flush();
+    }
+
+    unsigned long getFrames() const {
+        return frames;
+    }
+
+private:
+    static bool equals(const InputActions &a, const InputActions &b) {
+        return a.movement.x == b.movement.x
+               && a.movement.y == b.movement.y
+               && a.movement.z == b.movement.z
+               && a.rotation.x == b.rotation.x
+               && a.rotation.y == b.rotation.y
+               && a.boost == b.boost;
+    }
+
+    void writeU32(uint32_t value) {
+        char b[4];
+        ::writeU32(b, value);
+        stream.write(b, sizeof(b));
+    }
+
+    void writeF32(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeU32(bits);
+    }
+
+    std::ostream &stream;
+    InputActions previous;
+    unsigned long frames = 0;
+};
+
+// Reads a log written by the InputRecorder frame by frame.
+class InputReplay {
+public:
+    explicit InputReplay(std::istream &stream)
+            : stream(stream) {
+        char magic[4];
+        stream.read(magic, sizeof(magic));
+        if (stream.gcount() != sizeof(magic) || std::memcmp(magic, InputRecorder::MAGIC, sizeof(magic)) != 0)
+            throw std::runtime_error("Not an input recording");
+        uint32_t version;
+        if (!readU32(version) || version != InputRecorder::VERSION)
+            throw std::runtime_error("Unsupported input recording version");
+    }
+
+    /**
+     * Read the next frame, the actions keep their previous value if they did not change.
+     * A truncated last frame, e.g. from a recording that was killed, ends the replay.
+     *
+     * @return False if the end of the recording was reached
+     */
+    bool next(float &deltaTime, InputActions &actions) {
+        auto flags = stream.get();
+        if (flags == std::char_traits<char>::eof() || !readF32(deltaTime))
+            return false;
+
+        if (flags & InputRecorder::FRAME_ACTIONS) {
+            float values[5];
+            for (auto &value: values) {
+                if (!readF32(value))
+                    return false;
+            }
+            current.movement = Vec3f(values[0], values[1], values[2]);
+            current.rotation = Vec3f(values[3], values[4], 0);
+            current.boost = (flags & InputRecorder::FRAME_BOOST) != 0;
+        }
+
+        actions = current;
+        frames++;
+        return true;
+    }
+
+    unsigned long getFrames() const {
+        return frames;
+    }
+
+private:
+    bool readU32(uint32_t &value) {
+        char b[4];
+        stream.read(b, sizeof(b));
+        if (stream.gcount() != sizeof(b))
+            return false;
+        value = ::readU32(b);
+        return true;
+    }
+
+    bool readF32(float &value) {
+        uint32_t bits;
+        if (!readU32(bits))
+            return false;
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+    std::istream &stream;
+    InputActions current;
+    unsigned long frames = 0;
+};
+
+#endif //MANA_INPUTRECORDING_HPP
@@ -0,0 +1,112 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_COMPRESSEDARCHIVE_HPP
+#define MANA_COMPRESSEDARCHIVE_HPP
+
+#include <istream>
+#include <streambuf>
+#include <memory>
+#include <vector>
+
+#include "io/archive.hpp"
+
+#include "pak/pakcompression.hpp"
+
+using namespace xengine;
+
+// Seekable input stream over an owned buffer, the decoded entries are handed out as these.
+class MemoryStream : public std::istream {
+public:
+    explicit MemoryStream(std::vector<char> data)
+            : std::istream(nullptr), buffer(std::move(data)) {
+        rdbuf(&buffer);
+    }
+
+private:
+    class Buffer : public std::streambuf {
+    public:
+        explicit Buffer(std::vector<char> data) : data(std::move(data)) {
+            setg(this->data.data(), this->data.data(), this->data.data() + this->data.size());
+        }
+
+    protected:
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+            off_type base;
+            if (dir == std::ios_base::beg)
+                base = 0;
+            else if (dir == std::ios_base::cur)
+                base = gptr() - eback();
+            else
+                base = egptr() - eback();
+            return seekpos(base + off, which);
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+            auto offset = static_cast<off_type>(pos);
+            if (!(which & std::ios_base::in) || offset < 0 || offset > egptr() - eback())
+                return pos_type(off_type(-1));
+            setg(eback(), eback() + offset, egptr());
+            return pos;
+        }
+
+    private:
+        std::vector<char> data;
+    };
+
+    Buffer buffer;
+};
+
+// Archive decorator which decodes entries written with PakCompression, plain entries are passed through.
+// Wrapping a PakArchive keeps the pak container unchanged while the entries shrink,
+// the blocks of an entry are decompressed in parallel on the pool.
+class CompressedArchive : public Archive {
+public:
+    explicit CompressedArchive(std::unique_ptr<Archive> archive,
+                               std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>())
+            : archive(std::move(archive)), pool(std::move(pool)) {}
+
+    bool exists(const std::string &path) override {
+        return archive->exists(path);
+    }
+
+    std::unique_ptr<std::istream> open(const std::string &path) override {
+        auto stream = archive->open(path);
+
+        std::vector<char> data;
+        char buf[64 * 1024];
+        while (*stream) {
+            stream->read(buf, sizeof(buf));
+            data.insert(data.end(), buf, buf + stream->gcount());
+        }
+
+        if (!PakCompression::isCompressed(data.data(), data.size()))
+            return std::make_unique<MemoryStream>(std::move(data));
+
+        std::vector<char> decoded;
+        PakCompression::decode(data.data(), data.size(), decoded, pool.get());
+        return std::make_unique<MemoryStream>(std::move(decoded));
+    }
+
+private:
+    std::unique_ptr<Archive> archive;
+    std::shared_ptr<ThreadPool> pool;
+};
+
+#endif //MANA_COMPRESSEDARCHIVE_HPP
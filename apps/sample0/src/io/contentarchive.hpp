@@ -0,0 +1,60 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_CONTENTARCHIVE_HPP
+#define MANA_CONTENTARCHIVE_HPP
+
+#include <map>
+#include <memory>
+
+#include "io/archive.hpp"
+
+#include "pak/pakmanifest.hpp"
+
+using namespace xengine;
+
+// Archive over a content addressed pak set written by ContentPak,
+// resolves entry paths through the manifest to the object in the chunk archive which stores it.
+class ContentArchive : public Archive {
+public:
+    ContentArchive(PakManifest manifest, std::map<int, std::unique_ptr<Archive>> chunks)
+            : manifest(std::move(manifest)), chunks(std::move(chunks)) {}
+
+    bool exists(const std::string &path) override {
+        return manifest.exists(path);
+    }
+
+    std::unique_ptr<std::istream> open(const std::string &path) override {
+        auto &object = manifest.getObject(path);
+        auto it = chunks.find(object.chunk);
+        if (it == chunks.end())
+            throw std::runtime_error("Pak chunk " + std::to_string(object.chunk) + " not loaded for " + path);
+        return it->second->open(object.path);
+    }
+
+    const PakManifest &getManifest() const {
+        return manifest;
+    }
+
+private:
+    PakManifest manifest;
+    std::map<int, std::unique_ptr<Archive>> chunks;
+};
+
+#endif //MANA_CONTENTARCHIVE_HPP
@@ -0,0 +1,186 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_LATENCYTRACKER_HPP
+#define MANA_LATENCYTRACKER_HPP
+
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <ostream>
+
+// Measures the time from the oldest input event consumed in a frame until the frame was presented.
+// The tracker owns the frame id, each stage of the frame is stamped against the current id,
+// so a stage of a later frame can never be attributed to the input of an earlier one.
+class LatencyTracker {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    enum Stage {
+        STAGE_INPUT, // Events drained and actions resolved
+        STAGE_UPDATE, // ECS updated, includes the render system submitting the pipeline
+        STAGE_PRESENT, // Swap buffers returned
+        STAGE_COUNT
+    };
+
+    struct Frame {
+        unsigned long id = 0;
+        bool hasInput = false;
+        Clock::time_point inputTime; // Timestamp of the oldest event consumed in this frame
+        Clock::time_point stages[STAGE_COUNT];
+    };
+
+    struct Distribution {
+        size_t samples = 0;
+        float min = 0;
+        float p50 = 0;
+        float p95 = 0;
+        float p99 = 0;
+        float max = 0;
+        float mean = 0;
+    };
+
+    explicit LatencyTracker(size_t historySize = 1000)
+            : historySize(historySize) {}
+
+    unsigned long beginFrame() {
+        current = {};
+        current.id = ++frameId;
+        return current.id;
+    }
+
+    // Called once per frame after draining the input queue, eventTime is the oldest consumed event
+    void setInput(Clock::time_point eventTime) {
+        current.hasInput = true;
+        current.inputTime = eventTime;
+    }
+
+    void stamp(Stage stage) {
+        current.stages[stage] = Clock::now();
+    }
+
+    // Commit the current frame, must be called after the present stage was stamped.
+    void endFrame() {
+        if (!current.hasInput)
+            return;
+
+        auto toMs = [](Clock::duration d) {
+            return std::chrono::duration<float, std::milli>(d).count();
+        };
+
+        push(latency, toMs(current.stages[STAGE_PRESENT] - current.inputTime));
+        push(queueLatency, toMs(current.stages[STAGE_INPUT] - current.inputTime));
+        push(updateLatency, toMs(current.stages[STAGE_UPDATE] - current.stages[STAGE_INPUT]));
+        push(presentLatency, toMs(current.stages[STAGE_PRESENT] - current.stages[STAGE_UPDATE]));
+
+        totalSamples++;
+    }
+
+    unsigned long getFrameId() const {
+        return frameId;
+    }
+
+    unsigned long getTotalSamples() const {
+        return totalSamples;
+    }
+
+    // Input to present latency in milliseconds of the most recent frames with input, newest last
+    const std::vector<float> &getHistory() const {
+        return latency;
+    }
+
+    Distribution getDistribution() const {
+        return computeDistribution(latency);
+    }
+
+    void writeReport(std::ostream &stream) const {
+        stream << "{\n";
+        writeDistribution(stream, "inputToPresent", computeDistribution(latency));
+        stream << ",\n";
+        writeDistribution(stream, "eventToInputStage", computeDistribution(queueLatency));
+        stream << ",\n";
+        writeDistribution(stream, "inputToUpdateEnd", computeDistribution(updateLatency));
+        stream << ",\n";
+        writeDistribution(stream, "updateEndToPresent", computeDistribution(presentLatency));
+        stream << ",\n  \"frames\": " << frameId
+               << ",\n  \"framesWithInput\": " << totalSamples
+               << "\n}\n";
+    }
+
+private:
+    void push(std::vector<float> &history, float value) {
+        if (history.size() >= historySize)
+            history.erase(history.begin());
+        history.emplace_back(value);
+    }
+
+    Distribution computeDistribution(const std::vector<float> &history) const {
+        Distribution ret;
+        if (history.empty())
+            return ret;
+
+        scratch.assign(history.begin(), history.end());
+        std::sort(scratch.begin(), scratch.end());
+
+        auto percentile = [this](float p) {
+            return scratch.at(static_cast<size_t>(p * static_cast<float>(scratch.size() - 1)));
+        };
+
+        ret.samples = scratch.size();
+        ret.min = scratch.front();
+        ret.max = scratch.back();
+        ret.p50 = percentile(0.5f);
+        ret.p95 = percentile(0.95f);
+        ret.p99 = percentile(0.99f);
+
+        double sum = 0;
+        for (auto v: scratch)
+            sum += v;
+        ret.mean = static_cast<float>(sum / static_cast<double>(scratch.size()));
+
+        return ret;
+    }
+
+    static void writeDistribution(std::ostream &stream, const char *name, const Distribution &d) {
+        stream << "  \"" << name << "\": {"
+               << "\"samples\": " << d.samples
+               << ", \"min\": " << d.min
+               << ", \"mean\": " << d.mean
+               << ", \"p50\": " << d.p50
+               << ", \"p95\": " << d.p95
+               << ", \"p99\": " << d.p99
+               << ", \"max\": " << d.max
+               << "}";
+    }
+
+    size_t historySize;
+
+    unsigned long frameId = 0;
+    unsigned long totalSamples = 0;
+    Frame current;
+
+    std::vector<float> latency;
+    std::vector<float> queueLatency;
+    std::vector<float> updateLatency;
+    std::vector<float> presentLatency;
+
+    mutable std::vector<float> scratch;
+};
+
+#endif //MANA_LATENCYTRACKER_HPP
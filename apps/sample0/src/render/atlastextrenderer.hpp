@@ -0,0 +1,166 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_ATLASTEXTRENDERER_HPP
+#define MANA_ATLASTEXTRENDERER_HPP
+
+#include <map>
+#include <memory>
+
+#include "xengine.hpp"
+
+#include "render/glyphatlas.hpp"
+#include "render/spritebatch.hpp"
+
+using namespace xengine;
+
+// Draws text as one quad per glyph from a persistent glyph atlas texture.
+// The quads go into the sprite batch of the current pass, so text does not need a pass of its own,
+// and strings made of cached glyphs cost no rasterization or texture allocation.
+class AtlasTextRenderer {
+public:
+    AtlasTextRenderer(Font &font, RenderDevice &device, int atlasSize = 512, int cellSize = 64)
+            : font(font),
+              atlas(atlasSize, atlasSize, cellSize),
+              image(atlasSize, atlasSize) {
+        TextureBuffer::Attributes attributes;
+        attributes.size = Vec2i(atlasSize, atlasSize);
+        texture = device.getAllocator().createTextureBuffer(attributes);
+        texture->upload(image);
+    }
+
+    Vec2f getSize(const std::string &text, int pixelSize) {
+        auto &characters = getCharacters(pixelSize);
+        float width = 0;
+        for (auto c: text) {
+            auto it = characters.find(c);
+            if (it != characters.end())
+                width += static_cast<float>(getAdvance(it->second));
+        }
+        return {width, static_cast<float>(pixelSize)};
+    }
+
+    /**
+     * Queue the quads of the text into the batch.
+     *
+     * @param position The top left corner of the text
+     */
+    void draw(SpriteBatch &batch, const std::string &text, int pixelSize, Vec2f position, ColorRGBA color, int layer = 0) {
+        auto &characters = getCharacters(pixelSize);
+
+        quads.clear();
+        float penX = position.x;
+        float baseline = position.y + static_cast<float>(pixelSize);
+        for (auto c: text) {
+            auto it = characters.find(c);
+            if (it == characters.end())
+                continue;
+
+            auto &character = it->second;
+            auto &glyph = character.image;
+            Vec2f size(static_cast<float>(glyph.getWidth()), static_cast<float>(glyph.getHeight()));
+
+            GlyphAtlas::Cell cell{};
+            bool rasterize;
+            if (size.x > 0 && size.y > 0
+                && atlas.acquire(GlyphAtlas::getKey(static_cast<unsigned char>(c), pixelSize), cell, rasterize)) {
+                if (rasterize)
+                    writeGlyph(glyph, cell);
+                // Glyphs larger than a cell are cropped, the destination is cropped the same way to keep the scale
+                auto cellSize = static_cast<float>(atlas.getCellSize());
+                Vec2f origin(static_cast<float>(cell.x), static_cast<float>(cell.y));
+                Vec2f cropped(std::min(size.x, cellSize), std::min(size.y, cellSize));
+                quads.emplace_back(Quad{Rectf(origin, cropped),
+                                        Rectf(Vec2f(penX + static_cast<float>(character.bearing.x),
+                                                    baseline - static_cast<float>(character.bearing.y)),
+                                              cropped)});
+            }
+
+            penX += static_cast<float>(getAdvance(character));
+        }
+
+        // New glyphs are uploaded once before the quads referencing them are flushed
+        if (dirty) {
+            texture->upload(image);
+            uploads++;
+            dirty = false;
+        }
+
+        for (auto &quad: quads)
+            batch.draw(*texture, quad.src, quad.dst, color, layer);
+    }
+
+    // Glyphs drawn before this call may be evicted by later draws.
+    void nextFrame() {
+        atlas.nextFrame();
+    }
+
+    GlyphAtlas::Stats getAtlasStats() const {
+        return atlas.getStats();
+    }
+
+    unsigned long getUploads() const {
+        return uploads;
+    }
+
+private:
+    struct Quad {
+        Rectf src;
+        Rectf dst;
+    };
+
+    // The advance is stored in 1/64 pixels as reported by freetype
+    static int getAdvance(const Character &character) {
+        return character.advance >> 6;
+    }
+
+    // The ascii set of a size is rasterized once, the atlas then decides which glyphs are resident on the gpu.
+    const std::map<char, Character> &getCharacters(int pixelSize) {
+        auto it = characters.find(pixelSize);
+        if (it != characters.end())
+            return it->second;
+        font.setPixelSize(Vec2i(0, pixelSize));
+        return characters[pixelSize] = font.renderAscii();
+    }
+
+    void writeGlyph(const ImageRGBA &glyph, GlyphAtlas::Cell cell) {
+        auto cellSize = atlas.getCellSize();
+        for (int y = 0; y < cellSize; y++) {
+            for (int x = 0; x < cellSize; x++) {
+                if (x < glyph.getWidth() && y < glyph.getHeight())
+                    image.setPixel(cell.x + x, cell.y + y, glyph.getPixel(x, y));
+                else
+                    image.setPixel(cell.x + x, cell.y + y, ColorRGBA(0, 0, 0, 0));
+            }
+        }
+        dirty = true;
+    }
+
+    Font &font;
+    GlyphAtlas atlas;
+    ImageRGBA image;
+    std::unique_ptr<TextureBuffer> texture;
+    bool dirty = false;
+    unsigned long uploads = 0;
+
+    std::map<int, std::map<char, Character>> characters;
+    std::vector<Quad> quads;
+};
+
+#endif //MANA_ATLASTEXTRENDERER_HPP
@@ -0,0 +1,65 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_SPRITEBATCH_HPP
+#define MANA_SPRITEBATCH_HPP
+
+#include "xengine.hpp"
+
+#include "render/spritequeue.hpp"
+
+using namespace xengine;
+
+// Queues the 2d draws of a pass and submits them to Renderer2D sorted by layer and texture,
+// so that consecutive draws share their state. Call flush() between renderBegin() and renderPresent().
+class SpriteBatch {
+public:
+    struct Sprite {
+        TextureBuffer *texture;
+        Rectf src;
+        Rectf dst;
+        ColorRGBA color;
+        bool fill;
+    };
+
+    void draw(Rectf dstRect, ColorRGBA color, bool fill = true, int layer = 0) {
+        queue.push(nullptr, layer, Sprite{nullptr, {}, dstRect, color, fill});
+    }
+
+    void draw(TextureBuffer &texture, Rectf srcRect, Rectf dstRect, ColorRGBA color, int layer = 0) {
+        queue.push(&texture, layer, Sprite{&texture, srcRect, dstRect, color, true});
+    }
+
+    void flush(Renderer2D &ren2d) {
+        queue.flush([&ren2d](const void *, const Sprite &sprite, bool) {
+            if (sprite.texture == nullptr)
+                ren2d.draw(sprite.dst, sprite.color, sprite.fill);
+            else
+                ren2d.draw(sprite.src, *sprite.texture, sprite.dst, Vec2f(), 0, 1, 0, sprite.color);
+        });
+    }
+
+    const SpriteQueueStats &getStats() const {
+        return queue.getStats();
+    }
+
+    SpriteQueue<Sprite> queue;
+};
+
+#endif //MANA_SPRITEBATCH_HPP
@@ -25,15 +25,45 @@
 #include <filesystem>
 #include <memory>
 #include <fstream>
+#include <cstdlib>
+#include <cmath>
 
 #include "systems/playerinputsystem.hpp"
 #include "components/playercontrollercomponent.hpp"
 #include "systems/transformanimationsystem.hpp"
 #include "components/transformanimationcomponent.hpp"
+#include "systems/streamingaudiosystem.hpp"
+#include "components/streamingaudiosourcecomponent.hpp"
+#include "systems/taggedsystem.hpp"
+#include "systems/lightclustersystem.hpp"
+#include "systems/scriptbridgesystem.hpp"
+#include "systems/occlusioncullingsystem.hpp"
+#include "systems/texturestreamingsystem.hpp"
+
+#include "scripting/nativescriptruntime.hpp"
+#include "scripting/inputcontrollerscript.hpp"
 
 #include "gui/debugwindow.hpp"
 
+#include "render/atlastextrenderer.hpp"
+
+#include "input/inputeventqueue.hpp"
+#include "input/actionmapper.hpp"
+#include "input/inputrecording.hpp"
+
+#include "profiling/latencytracker.hpp"
+#include "profiling/startupprofiler.hpp"
+
+#include "memory/framearena.hpp"
+#include "memory/allocationtracker.hpp"
+
+#include "render/framegraphplanner.hpp"
+
 #include "io/byte.hpp"
+#include "io/compressedarchive.hpp"
+#include "io/contentarchive.hpp"
+
+#include "pak/contentpak.hpp"
 
 #include <iostream>
 
@@ -44,34 +74,82 @@ using namespace xengine;
 // The pak file format retrieval complexity should not be affected by the pak file size,
 // the use of pak splitting is for example when a filesystem does not support large files or
 // cloud storage with file size limits.
-static void createPackFromDirectory(const std::string &dir, long chunkSize) {
+// Identical files are stored once, the entries are grouped into chunk paks of up to chunkSize bytes and
+// dir.manifest maps the paths to the chunks. In incremental mode the chunks of the previous manifest are kept
+// and only the chunks holding new content are written, so a patch only has to upload those and the manifest.
+// The entries are compressed with the codec the policy selects for their extension before they are packed.
+static ContentPak::Stats createPackFromDirectory(const std::string &dir,
+                                                 long chunkSize,
+                                                 bool incremental = false,
+                                                 const PakCompression::Policy &policy = {}) {
     auto entries = Pak::readEntries(dir);
-    auto chunks = Pak::createPak(entries, chunkSize);
 
     auto cs = dir + ".";
     auto ce = ".pak";
+    auto manifestFile = dir + ".manifest";
+
+    PakManifest previous;
+    bool havePrevious = false;
+    if (incremental && std::filesystem::exists(manifestFile)) {
+        std::ifstream fs(manifestFile);
+        previous = PakManifest::read(fs);
+        havePrevious = true;
+    }
+
+    auto result = ContentPak::build(entries,
+                                    havePrevious ? &previous : nullptr,
+                                    chunkSize > 0 ? static_cast<size_t>(chunkSize) : 0);
+
+    ThreadPool pool;
+    for (auto &chunk: result.chunks) {
+        PakCompression::compressEntries(chunk.second, policy, &pool);
 
-    int ci = 0;
-    for (auto &c: chunks) {
         auto fileName = cs;
-        fileName += std::to_string(ci);
+        fileName += std::to_string(chunk.first);
         fileName += ce;
 
-        std::ofstream fs(fileName);
-        fs.write(chunks.at(ci).data(), chunks.at(ci).size());
-        ci++;
+        auto pak = Pak::createPak(chunk.second, 0);
+        std::ofstream fs(fileName, std::ios::binary);
+        fs.write(pak.at(0).data(), pak.at(0).size());
     }
-}
 
-static std::unique_ptr<PakArchive> loadPackArchive(const std::string &pakName, Archive &archive) {
-    std::vector<std::unique_ptr<std::istream>> streams;
+    // The manifest is replaced after the new chunks exist and the dropped chunks are deleted after that,
+    // an interrupted build leaves a readable pak set behind
+    {
+        std::ofstream fs(manifestFile);
+        result.manifest.write(fs);
+    }
+
+    for (auto ci: result.removedChunks) {
+        std::filesystem::remove(cs + std::to_string(ci) + ce);
+    }
 
-    auto cs = pakName + ".";
+    return result.stats;
+}
+
+static std::unique_ptr<Archive> loadPackArchive(const std::string &pakName, Archive &archive) {
+    auto cs = "/" + pakName + ".";
     auto ce = ".pak";
 
+    auto manifestFile = "/" + pakName + ".manifest";
+    if (archive.exists(manifestFile)) {
+        auto manifest = PakManifest::read(*archive.open(manifestFile));
+
+        std::map<int, std::unique_ptr<Archive>> chunks;
+        for (auto ci: manifest.getChunks()) {
+            std::vector<std::unique_ptr<std::istream>> streams;
+            streams.emplace_back(archive.open(cs + std::to_string(ci) + ce));
+            chunks[ci] = std::make_unique<PakArchive>(std::move(streams));
+        }
+
+        return std::make_unique<CompressedArchive>(std::make_unique<ContentArchive>(std::move(manifest),
+                                                                                    std::move(chunks)));
+    }
+
+    // Split pak without manifest
+    std::vector<std::unique_ptr<std::istream>> streams;
     for (int i = 0; i < 100; i++) {
-        std::string fileName = "/";
-        fileName += cs;
+        auto fileName = cs;
         fileName += std::to_string(i);
         fileName += ce;
 
@@ -80,7 +158,7 @@ static std::unique_ptr<PakArchive> loadPackArchive(const std::string &pakName, A
         }
     }
 
-    return std::make_unique<PakArchive>(std::move(streams));
+    return std::make_unique<CompressedArchive>(std::make_unique<PakArchive>(std::move(streams)));
 }
 
 class Sample0 : public Application, InputListener {
@@ -89,6 +167,37 @@ public:
             : Application(argc,
                           argv),
               archive(std::make_unique<DirectoryArchive>(std::filesystem::current_path().string() + "/assets")) {
+        for (int i = 1; i < argc - 1; i++) {
+            if (std::string(argv[i]) == "--latency-report")
+                latencyReportPath = argv[i + 1];
+            if (std::string(argv[i]) == "--startup-report")
+                startupReportPath = argv[i + 1];
+            if (std::string(argv[i]) == "--record") {
+                recordStream.open(argv[i + 1], std::ios::binary | std::ios::trunc);
+                if (recordStream.is_open())
+                    inputRecorder = std::make_unique<InputRecorder>(recordStream);
+                else
+                    std::cerr << "Failed to open " << argv[i + 1] << ", not recording" << std::endl;
+            }
+            if (std::string(argv[i]) == "--replay")
+                openReplay(argv[i + 1]);
+            if (std::string(argv[i]) == "--fixed-timestep") {
+                char *end;
+                auto value = std::strtof(argv[i + 1], &end);
+                if (end != argv[i + 1] && *end == 0 && value > 0 && std::isfinite(value))
+                    fixedTimestep = value;
+                else
+                    std::cerr << "Invalid fixed timestep " << argv[i + 1] << ", using the measured frame time"
+                              << std::endl;
+            }
+        }
+        for (int i = 1; i < argc; i++) {
+            if (std::string(argv[i]) == "--texture-streaming")
+                textureStreaming = true;
+        }
+
+        startupProfiler.begin("Renderer setup");
+
         imPlotContext = ImPlot::CreateContext();
 
         window->setSwapInterval(0);
@@ -104,60 +213,107 @@ public:
 
 protected:
     void start() override {
+        startupProfiler.begin("Font");
+
         {
             auto s = archive->open("fonts/roboto/Roboto-Regular.ttf");
             font = Font::createFont(*s);
         }
 
-        textRenderer = std::make_unique<TextRenderer>(*font, *renderDevice);
+        textRenderer = std::make_unique<AtlasTextRenderer>(*font, *renderDevice);
 
         ResourceRegistry::getDefaultRegistry().setArchive(archive);
 
         drawLoadingScreen(0.1, "Setting up render passes...");
 
-        std::vector<std::shared_ptr<RenderPass>> passes;
-        passes.emplace_back(std::move(std::make_shared<GBufferPass>(*renderDevice)));
-        passes.emplace_back(std::move(std::make_shared<SkyboxPass>(*renderDevice)));
-        passes.emplace_back(std::move(std::make_shared<PhongPass>(*renderDevice)));
-        passes.emplace_back(std::move(std::make_shared<CompositePass>(*renderDevice)));
+        startupProfiler.begin("Render passes");
 
-        pipeline = std::make_unique<FrameGraphPipeline>(*renderDevice);
+        {
+            AllocationScope scope(ALLOC_RENDER);
+
+            passes.emplace_back(std::move(std::make_shared<GBufferPass>(*renderDevice)));
+            passes.emplace_back(std::move(std::make_shared<SkyboxPass>(*renderDevice)));
+            passes.emplace_back(std::move(std::make_shared<PhongPass>(*renderDevice)));
+            passes.emplace_back(std::move(std::make_shared<CompositePass>(*renderDevice)));
 
-        pipeline->setPasses(std::move(passes));
+            pipeline = std::make_unique<FrameGraphPipeline>(*renderDevice);
+        }
+
+        setupFrameGraphPlanner();
 
         drawLoadingScreen(0.6, "Initializing Systems...");
 
+        startupProfiler.begin("Systems");
+
         renderSystem = new RenderSystem(window->getRenderTarget(),
                                         *pipeline);
 
+        streamingAudioSystem = new StreamingAudioSystem(*audioDevice, *archive);
+
+        lightClusterSystem = new LightClusterSystem();
+
+        // The scene attaches the InputController script to the camera, it runs natively through the batched bridge
+        scriptRuntime.registerClass("/scripts/script.dll:InputController",
+                                    InputControllerScript(actionMapper.getActions()));
+        scriptBridgeSystem = new ScriptBridgeSystem(scriptRuntime);
+
+        workerPool = std::make_unique<ThreadPool>();
+        occlusionCullingSystem = new OcclusionCullingSystem(*workerPool);
+        std::vector<System *> systems = {
+                new TaggedSystem(ALLOC_ECS, new PlayerInputSystem(actionMapper.getActions())),
+                new TaggedSystem(ALLOC_ECS, scriptBridgeSystem),
+                new TaggedSystem(ALLOC_ECS, new TransformAnimationSystem()),
+                new TaggedSystem(ALLOC_AUDIO, new AudioSystem(*audioDevice,
+                                                              ResourceRegistry::getDefaultRegistry())),
+                new TaggedSystem(ALLOC_AUDIO, streamingAudioSystem),
+                new TaggedSystem(ALLOC_RENDER, lightClusterSystem),
+                new TaggedSystem(ALLOC_RENDER, occlusionCullingSystem)
+        };
+
+        // The render system still binds the eagerly loaded textures of the materials, so the streamed
+        // buffers have no consumer yet and would only add a second decode and upload of every texture.
+        if (textureStreaming) {
+            textureStreamingSystem = new TextureStreamingSystem(*workerPool,
+                                                                *archive,
+                                                                *renderDevice,
+                                                                debugWindow.getTextureBudget());
+            systems.emplace_back(new TaggedSystem(ALLOC_RESOURCES, textureStreamingSystem));
+        }
+
+        systems.emplace_back(new TaggedSystem(ALLOC_RENDER, renderSystem));
+
         //Move is required because the ECS destructor deletes the system pointers.
-        ecs = std::move(ECS(
-                {
-                        new PlayerInputSystem(window->getInput()),
-                        new TransformAnimationSystem(),
-                        new AudioSystem(*audioDevice, ResourceRegistry::getDefaultRegistry()),
-                        renderSystem
-                }
-        ));
+        ecs = std::move(ECS(systems));
         ecs.start();
 
         drawLoadingScreen(0.7, "Loading Scene...");
 
+        startupProfiler.begin("Scene");
+
         int maxSamples = renderDevice->getMaxSampleCount();
         debugWindow.setMaxSamples(maxSamples);
         debugWindow.setSamples(1);
 
         auto &device = *renderDevice;
 
-        auto stream = archive->open("/scene.json");
-        ecs.getEntityManager() << JsonProtocol().deserialize(*stream);
+        {
+            AllocationScope scope(ALLOC_RESOURCES);
+            auto stream = archive->open("/scene.json");
+            ecs.getEntityManager() << JsonProtocol().deserialize(*stream);
+        }
 
         auto &entityManager = ecs.getEntityManager();
         auto &componentManager = entityManager.getComponentManager();
 
         cameraEntity = entityManager.getByName("MainCamera");
 
-        componentManager.create<PlayerControllerComponent>(cameraEntity);
+        // The camera is moved by its InputController script instead of a PlayerControllerComponent
+
+        // The music track is streamed instead of being loaded through the resource registry
+        StreamingAudioSourceComponent music;
+        music.path = "/audio/Farbro-Tectonic-Mono.wav";
+        music.loop = true;
+        componentManager.create<StreamingAudioSourceComponent>(cameraEntity, music);
 
         auto islandEntity = entityManager.getByName("Island");
         componentManager.create<TransformAnimationComponent>(islandEntity, {{},
@@ -170,16 +326,41 @@ protected:
         auto sphereEntity = entityManager.getByName("Sphere");
         componentManager.create<TransformAnimationComponent>(sphereEntity, {{},
                                                                             {7.151281, 61.985, 24.78}});
+
+        // The solid meshes of the scene, the foliage is alpha tested and must not occlude
+        occlusionCullingSystem->setOccluders({entityManager.getByName("stone"),
+                                              entityManager.getByName("wood"),
+                                              planeEntity});
         window->getInput().addListener(*this);
+        window->getInput().addListener(inputQueue);
 
         drawLoadingScreen(1, "Loading Finished!");
 
+        // Includes the resources loaded on first use by the render system
+        startupProfiler.begin("First frame");
+
         Application::start();
     }
 
     void stop() override {
+        window->getInput().removeListener(inputQueue);
         window->getInput().removeListener(*this);
 
+        if (!latencyReportPath.empty()) {
+            std::ofstream fs(latencyReportPath);
+            latencyTracker.writeReport(fs);
+        }
+
+        if (inputRecorder) {
+            inputRecorder->flush();
+            std::cout << "Recorded " << inputRecorder->getFrames() << " frames" << std::endl;
+        }
+
+        if (!startupReportPath.empty()) {
+            std::ofstream fs(startupReportPath);
+            startupProfiler.writeReport(fs);
+        }
+
         ecs.getEntityManager().clear();
         ecs.stop();
         ecs = ECS();
@@ -192,10 +373,34 @@ protected:
     void update(float deltaTime) override {
         auto frameStart = std::chrono::high_resolution_clock::now();
 
+        latencyTracker.beginFrame();
+
         auto &wnd = *window;
 
         wnd.update();
 
+        actionMapper.resolve(inputQueue, wnd.getInput());
+        if (actionMapper.getEventCount() > 0)
+            latencyTracker.setInput(actionMapper.getOldestEventTime());
+
+        if (fixedTimestep > 0)
+            deltaTime = fixedTimestep;
+
+        // The replayed actions and timestep replace the live ones, the live input takes over when the log ends
+        if (inputReplay) {
+            InputActions actions;
+            if (inputReplay->next(deltaTime, actions)) {
+                actionMapper.setActions(actions);
+            } else {
+                std::cout << "Replay finished after " << inputReplay->getFrames() << " frames" << std::endl;
+                inputReplay.reset();
+            }
+        }
+
+        if (inputRecorder)
+            inputRecorder->record(deltaTime, actionMapper.getActions());
+        latencyTracker.stamp(LatencyTracker::STAGE_INPUT);
+
         auto wndSize = wnd.getFramebufferSize();
 
         auto &entityManager = ecs.getEntityManager();
@@ -209,11 +414,38 @@ protected:
 
         debugWindow.setDrawCalls(drawCalls);
         debugWindow.setPolyCount(renderSystem->getPolyCount());
+        auto &voiceManager = streamingAudioSystem->getVoiceManager();
+        voiceManager.setMaxVoices(debugWindow.getMaxVoices());
+        debugWindow.setVoiceCount(voiceManager.getActiveVoices(), voiceManager.getVirtualVoices());
+        debugWindow.setAudioStreamStats(streamingAudioSystem->getResidentBytes(),
+                                        streamingAudioSystem->getUnderruns());
+        if (showDebugWindow)
+            debugWindow.setLatency(latencyTracker.getHistory(), latencyTracker.getDistribution());
+        debugWindow.setLightClusterStats(lightClusterSystem->getGrid().getStats(),
+                                         lightClusterSystem->getGrid().getClusterCount(),
+                                         lightClusterSystem->getDirectionalLights(),
+                                         lightClusterSystem->getBuildTime());
+        lightClusterSystem->setEnabled(debugWindow.getLightClustering());
+        debugWindow.setTextStats(textRenderer->getAtlasStats(), textRenderer->getUploads());
+        debugWindow.setSpriteStats(spriteBatch.getStats());
+        debugWindow.setScriptStats(scriptBridgeSystem->getStats(), scriptBridgeSystem->getBridgeTime());
+        scriptBridgeSystem->getBatcher().setBatching(debugWindow.getScriptBatching());
+        debugWindow.setOcclusionStats(occlusionCullingSystem->getStats(),
+                                      occlusionCullingSystem->getParkedCount(),
+                                      occlusionCullingSystem->getWaitTime());
+        occlusionCullingSystem->setEnabled(debugWindow.getOcclusionCulling());
+        if (textureStreamingSystem) {
+            debugWindow.setTextureStreamingStats(textureStreamingSystem->getStats());
+            textureStreamingSystem->setBudget(debugWindow.getTextureBudget());
+            textureStreamingSystem->setViewportHeight(wndSize.y);
+        }
+        debugWindow.setStartupPhases(startupProfiler.getPhases(), startupProfiler.getTotal());
+        debugWindow.setArenaStats(FrameArena::getThreadArena().getStats());
+        debugWindow.setAllocationSnapshot(AllocationTracker::get().snapshot());
         debugWindow.setFrameBufferSize(wnd.getFramebufferSize());
         debugWindow.setVideoModes(displayDriver->getPrimaryMonitor()->getSupportedVideoModes());
 
-        pipeline->setRenderSamples(debugWindow.getSamples());
-        pipeline->setRenderResolution(debugWindow.getRenderResolution());
+        updatePipeline(componentManager);
 
         wnd.setSwapInterval(debugWindow.getSwapInterval());
 
@@ -221,6 +453,11 @@ protected:
 
         ecs.update(deltaTime);
 
+        latencyTracker.stamp(LatencyTracker::STAGE_UPDATE);
+
+        if (showHud)
+            drawHud();
+
         if (showDebugWindow)
             drawDebugWindow();
 
@@ -238,6 +475,16 @@ protected:
 
         wnd.swapBuffers();
 
+        latencyTracker.stamp(LatencyTracker::STAGE_PRESENT);
+        latencyTracker.endFrame();
+
+        if (startupProfiler.isActive())
+            startupProfiler.end();
+
+        textRenderer->nextFrame();
+
+        FrameArena::getThreadArena().reset();
+
         if (fpsLimit != 0) {
             auto delta = std::chrono::high_resolution_clock::now() - frameStart;
             auto time = std::chrono::nanoseconds(static_cast<long>(1000000000.0f / fpsLimit));
@@ -249,9 +496,11 @@ private:
     void onKeyDown(KeyboardKey key) override {
         if (key == KEY_F1) {
             showDebugWindow = !showDebugWindow;
+        } else if (key == KEY_F3) {
+            showHud = !showHud;
         } else if (key == KEY_F2) {
             auto &cmgr = ecs.getEntityManager().getComponentManager();
-            auto comp = cmgr.lookup<AudioSourceComponent>(cameraEntity);
+            auto comp = cmgr.lookup<StreamingAudioSourceComponent>(cameraEntity);
             comp.play = !comp.play;
             cmgr.update(cameraEntity, comp);
         }
@@ -282,35 +531,118 @@ private:
         Vec2f barSize(400, 50);
         Vec2f halfBarSize = barSize / 2;
         Vec2f pos = targetHalfSize.convert<float>() - halfBarSize + Vec2f(0, 100);
-        ren2d->draw(Rectf(pos, barSize),
-                    barBgColor,
-                    true);
+        spriteBatch.draw(Rectf(pos, barSize),
+                         barBgColor,
+                         true);
 
         // Draw foreground bar
         Vec2f fgBarSize(barSize.x * progress, barSize.y);
-        ren2d->draw(Rectf(pos, fgBarSize),
-                    barFgColor,
-                    true);
+        spriteBatch.draw(Rectf(pos, fgBarSize),
+                         barFgColor,
+                         true);
+
+        // Draw text, queued into the same pass as the bars
+        int fontSize = 40;
+        auto textSize = textRenderer->getSize(loadingText, fontSize);
+        auto textPos = targetHalfSize.convert<float>() - textSize / 2;
+        textRenderer->draw(spriteBatch, loadingText, fontSize, textPos, textColor);
 
+        spriteBatch.flush(*ren2d);
         ren2d->renderPresent();
 
-        //Draw text
-        textRenderer->setFontSize(Vec2i(40, 0));
-        auto text = textRenderer->render(loadingText, 50);
-        auto textSize = text.getTexture().getAttributes().size;
-        auto textHalfSize = textSize / 2;
-        auto textPos = targetHalfSize - textHalfSize - Vec2i(0, 0);
+        textRenderer->nextFrame();
 
-        auto dstRect = Rectf(textPos.convert<float>(), textSize.convert<float>());
+        window->swapBuffers();
+    }
 
-        ren2d->renderBegin(target, false);
-        ren2d->draw(text, dstRect, textColor);
-        ren2d->renderPresent();
+    // Describes the passes in the order of the passes vector and the targets they exchange.
+    // The attachment sizes mirror the formats the engine passes allocate and are used for the memory estimate.
+    // A replay that can not be opened or read is reported and the sample runs on the live input instead
+    void openReplay(const std::string &path) {
+        replayStream.open(path, std::ios::binary);
+        if (!replayStream.is_open()) {
+            std::cerr << "Failed to open " << path << ", not replaying" << std::endl;
+            return;
+        }
+        try {
+            inputReplay = std::make_unique<InputReplay>(replayStream);
+        } catch (const std::runtime_error &e) {
+            std::cerr << "Failed to replay " << path << ": " << e.what() << std::endl;
+            replayStream.close();
+        }
+    }
 
-        window->swapBuffers();
+    void setupFrameGraphPlanner() {
+        planner.addResource("gbuffer_position", 16, true);
+        planner.addResource("gbuffer_normal", 16, true);
+        planner.addResource("gbuffer_tangent", 16, true);
+        planner.addResource("gbuffer_texture_normal", 16, true);
+        planner.addResource("gbuffer_diffuse", 4, true);
+        planner.addResource("gbuffer_ambient", 4, true);
+        planner.addResource("gbuffer_specular", 4, true);
+        planner.addResource("gbuffer_model_object", 8, true);
+        planner.addResource("gbuffer_depth", 4, true);
+        planner.addResource("skybox", 4, false);
+        planner.addResource("phong", 4, false);
+        planner.addResource("phong_depth", 4, false);
+
+        std::vector<std::string> gbuffer = {"gbuffer_position", "gbuffer_normal", "gbuffer_tangent",
+                                            "gbuffer_texture_normal", "gbuffer_diffuse", "gbuffer_ambient",
+                                            "gbuffer_specular", "gbuffer_model_object", "gbuffer_depth"};
+
+        planner.addPass("GBuffer", {}, gbuffer);
+        planner.addPass("Skybox", {}, {"skybox"});
+        planner.addPass("Phong", gbuffer, {"phong", "phong_depth"});
+        planner.addPass("Composite", {"skybox", "phong", "phong_depth"}, {"screen"});
+    }
+
+    // Applies pass culling and the render settings to the pipeline, only touching it when something changed
+    // because every reconfiguration reallocates the render targets.
+    void updatePipeline(ComponentManager &componentManager) {
+        // The sample scene has a skybox, the toggle exercises the culled configuration
+        auto &skyboxes = componentManager.getPool<SkyboxComponent>();
+        bool skybox = skyboxes.begin() != skyboxes.end() && debugWindow.getSkyboxPass();
+
+        auto resolution = debugWindow.getRenderResolution();
+        auto samples = debugWindow.getSamples();
+
+        if (pipelineConfigured
+            && skybox == skyboxEnabled
+            && resolution == renderResolution
+            && samples == renderSamples)
+            return;
+
+        planner.setPassEnabled("Skybox", skybox);
+        auto plan = planner.compile("screen", resolution.x, resolution.y, samples);
+
+        if (!pipelineConfigured || plan.passes != framePlan.passes) {
+            std::vector<std::shared_ptr<RenderPass>> activePasses;
+            for (auto index: plan.passes)
+                activePasses.emplace_back(passes.at(index));
+            pipeline->setPasses(activePasses);
+            pipelineReconfigurations++;
+        }
+
+        if (!pipelineConfigured || resolution != renderResolution || samples != renderSamples) {
+            pipeline->setRenderSamples(samples);
+            pipeline->setRenderResolution(resolution);
+            pipelineReconfigurations++;
+        }
+
+        pipelineConfigured = true;
+        skyboxEnabled = skybox;
+        renderResolution = resolution;
+        renderSamples = samples;
+        framePlan = plan;
+
+        debugWindow.setFrameGraphStats(plan.passes.size(),
+                                       passes.size(),
+                                       plan.targetBytes,
+                                       pipelineReconfigurations);
     }
 
     void drawDebugWindow() {
+        AllocationScope scope(ALLOC_RENDER);
         auto &wnd = *window;
         auto &target = window->getRenderTarget();
         ImGuiCompat::NewFrame(wnd);
@@ -322,25 +654,78 @@ private:
                               RenderOptions({}, target.getSize(), false, false, 1, {}, 1, false, false, false));
     }
 
+    // The fps counter changes every frame but only ever uses the cached glyphs of the atlas
+    void drawHud() {
+        AllocationScope scope(ALLOC_RENDER);
+        auto &target = window->getRenderTarget();
+        ren2d->renderBegin(target, false);
+        textRenderer->draw(spriteBatch,
+                           "FPS: " + std::to_string(static_cast<int>(fpsAverage)),
+                           20,
+                           Vec2f(10, 10),
+                           ColorRGBA(255, 255, 255, 255));
+        spriteBatch.flush(*ren2d);
+        ren2d->renderPresent();
+    }
+
 private:
+    // Declared before the ecs, the systems may still have jobs queued when they are deleted
+    std::unique_ptr<ThreadPool> workerPool;
+
     ECS ecs;
 
     Entity cameraEntity;
+
+    InputEventQueue inputQueue;
+    ActionMapper actionMapper;
+
+    LatencyTracker latencyTracker;
+    std::string latencyReportPath; // Written on stop if set with --latency-report <file>
+
+    StartupProfiler startupProfiler;
+    std::string startupReportPath; // Written on stop if set with --startup-report <file>
+
+    // --record <file> writes the actions and timestep of every frame, --replay <file> plays them back
+    std::ofstream recordStream;
+    std::unique_ptr<InputRecorder> inputRecorder;
+    std::ifstream replayStream;
+    std::unique_ptr<InputReplay> inputReplay;
+    float fixedTimestep = 0; // Replaces the measured deltaTime if set with --fixed-timestep <seconds>
+
+    // Texture streaming is only measured with --texture-streaming until the renderer can bind the streamed buffers
+    bool textureStreaming = false;
+
     double fpsAverage = 1;
     unsigned long drawCalls = 0;// The number of draw calls in the last update
 
     RenderSystem *renderSystem{};
+    StreamingAudioSystem *streamingAudioSystem{};
+    LightClusterSystem *lightClusterSystem{};
+    ScriptBridgeSystem *scriptBridgeSystem{};
+    OcclusionCullingSystem *occlusionCullingSystem{};
+    TextureStreamingSystem *textureStreamingSystem{};
+
+    NativeScriptRuntime scriptRuntime;
 
     int fullscreeenIndex = 0;
 
     float fpsLimit = 0;
 
     bool showDebugWindow = false;
+    bool showHud = false;
     DebugWindow debugWindow;
 
     std::unique_ptr<ResourceRegistry> resourceRegistry;
 
     std::unique_ptr<FrameGraphPipeline> pipeline;
+    std::vector<std::shared_ptr<RenderPass>> passes;
+    FrameGraphPlanner planner;
+    FrameGraphPlanner::Plan framePlan;
+    bool pipelineConfigured = false;
+    bool skyboxEnabled = false;
+    Vec2i renderResolution;
+    int renderSamples = 0;
+    unsigned long pipelineReconfigurations = 0;
     std::unique_ptr<Renderer2D> ren2d;
 
     ColorRGBA bgColor = {38, 38, 38, 255};
@@ -348,7 +733,8 @@ private:
     ImPlotContext *imPlotContext = nullptr;
 
     std::unique_ptr<Font> font;
-    std::unique_ptr<TextRenderer> textRenderer;
+    std::unique_ptr<AtlasTextRenderer> textRenderer;
+    SpriteBatch spriteBatch;
 
     std::shared_ptr<Archive> archive;
 };
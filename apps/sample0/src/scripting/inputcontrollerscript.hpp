@@ -0,0 +1,47 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_INPUTCONTROLLERSCRIPT_HPP
+#define MANA_INPUTCONTROLLERSCRIPT_HPP
+
+#include "systems/playerinputsystem.hpp"
+#include "systems/scriptbridgesystem.hpp"
+
+// Native implementation of the InputController script of the scene, registered with a NativeScriptRuntime.
+// Moves every entity of the batch like the PlayerInputSystem moves a PlayerControllerComponent.
+class InputControllerScript {
+public:
+    explicit InputControllerScript(const InputActions &actions)
+            : actions(actions) {}
+
+    void operator()(ScriptEntityData *entities, size_t count, float deltaTime) const {
+        for (size_t i = 0; i < count; i++) {
+            Transform transform;
+            ScriptBridgeSystem::unpackTransform(transform, entities[i]);
+            PlayerInputSystem::applyInput(transform, controller, actions, deltaTime);
+            ScriptBridgeSystem::packTransform(entities[i], transform);
+        }
+    }
+
+private:
+    const InputActions &actions;
+    PlayerControllerComponent controller;
+};
+
+#endif //MANA_INPUTCONTROLLERSCRIPT_HPP
@@ -0,0 +1,119 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_LIGHTCLUSTERSYSTEM_HPP
+#define MANA_LIGHTCLUSTERSYSTEM_HPP
+
+#include <chrono>
+#include <algorithm>
+
+#include "ecs/system.hpp"
+
+#include "render/lightclusters.hpp"
+
+using namespace xengine;
+
+// Bins the point and spot lights of the scene into the view space clusters of the main camera every frame.
+// Directional lights affect every cluster and are not binned.
+// Disabled by default because no pass reads the clusters yet, enabled from the debug window.
+class LightClusterSystem : public System {
+public:
+    void update(float deltaTime, EntityManager &entityManager) override {
+        if (!enabled) {
+            buildTime = 0;
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        auto &componentManager = entityManager.getComponentManager();
+
+        auto &cameras = componentManager.getPool<CameraComponent>();
+        if (cameras.begin() == cameras.end())
+            return;
+
+        auto cameraEntity = cameras.begin()->first;
+        auto &camera = cameras.begin()->second.camera;
+        auto cameraTransform = componentManager.lookup<TransformComponent>(cameraEntity).transform;
+
+        // The camera looks along negative z
+        auto position = cameraTransform.getPosition();
+        auto forward = cameraTransform.forward() * -1;
+        auto right = cameraTransform.left() * -1;
+        auto up = cameraTransform.up();
+
+        LightClusterGrid::View view{{position.x, position.y, position.z},
+                                    {right.x,    right.y,    right.z},
+                                    {up.x,       up.y,       up.z},
+                                    {forward.x,  forward.y,  forward.z},
+                                    camera.fov,
+                                    camera.aspectRatio,
+                                    camera.nearClip,
+                                    camera.farClip};
+
+        grid.clearLights();
+        directionalLights = 0;
+
+        for (auto &pair: componentManager.getPool<LightComponent>()) {
+            auto &light = pair.second.light;
+            if (light.type == LIGHT_DIRECTIONAL) {
+                directionalLights++;
+                continue;
+            }
+
+            float intensity = std::max(light.diffuse.x, std::max(light.diffuse.y, light.diffuse.z));
+            float radius = LightClusterGrid::getLightRadius(light.constant, light.linear, light.quadratic, intensity);
+            // A light which never reaches the cutoff contributes nothing and is not binned
+            if (radius <= 0)
+                continue;
+
+            auto lightPosition = componentManager.lookup<TransformComponent>(pair.first).transform.getPosition();
+            grid.addLight(lightPosition.x, lightPosition.y, lightPosition.z, radius);
+        }
+
+        grid.build(view);
+
+        buildTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void setEnabled(bool value) {
+        enabled = value;
+    }
+
+    const LightClusterGrid &getGrid() const {
+        return grid;
+    }
+
+    size_t getDirectionalLights() const {
+        return directionalLights;
+    }
+
+    // Milliseconds spent collecting and binning the lights in the last update
+    float getBuildTime() const {
+        return buildTime;
+    }
+
+private:
+    bool enabled = false;
+    LightClusterGrid grid;
+    size_t directionalLights = 0;
+    float buildTime = 0;
+};
+
+#endif //MANA_LIGHTCLUSTERSYSTEM_HPP
@@ -0,0 +1,294 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_OCCLUSIONCULLINGSYSTEM_HPP
+#define MANA_OCCLUSIONCULLINGSYSTEM_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <future>
+#include <chrono>
+#include <algorithm>
+
+#include "ecs/system.hpp"
+
+#include "render/occlusionculler.hpp"
+#include "concurrency/threadpool.hpp"
+
+#include "math/worldtransform.hpp"
+
+using namespace xengine;
+
+// Hides meshes which are behind the occluder entities from the RenderSystem.
+// Every frame the camera, the occluders and the bounds of all meshes are captured and tested on a worker thread,
+// the result is applied at the start of the next frame. Occluded entities have their MeshRenderComponent parked
+// in this system and restored once they become visible again, so the renderer needs no knowledge of the pass.
+// Because of the frame of latency an object coming into view appears one frame late.
+class OcclusionCullingSystem : public System {
+public:
+    explicit OcclusionCullingSystem(ThreadPool &pool, int width = 256, int height = 144)
+            : pool(pool), culler(width, height) {}
+
+    ~OcclusionCullingSystem() override {
+        if (pending.valid())
+            pending.wait();
+    }
+
+    // Only solid meshes should be occluders, they are rendered into the depth buffer and are never culled.
+    void setOccluders(const std::vector<Entity> &entities) {
+        occluders = std::set<Entity>(entities.begin(), entities.end());
+    }
+
+    void setEnabled(bool value) {
+        enabled = value;
+    }
+
+    void stop(EntityManager &entityManager) override {
+        finishJob();
+        restoreAll(entityManager.getComponentManager());
+    }
+
+    void update(float deltaTime, EntityManager &entityManager) override {
+        auto &componentManager = entityManager.getComponentManager();
+
+        auto waitStart = std::chrono::steady_clock::now();
+        auto result = finishJob();
+        waitTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+
+        if (!enabled) {
+            restoreAll(componentManager);
+            stats = {};
+            return;
+        }
+
+        apply(result, componentManager);
+
+        if (!capture(entityManager)) {
+            stats = {};
+            return;
+        }
+
+        // The job only reads the captured frame and the mesh cache, both stay untouched until finishJob()
+        pending = pool.submit([this]() {
+            return run();
+        });
+    }
+
+    const OcclusionCuller::Stats &getStats() const {
+        return stats;
+    }
+
+    size_t getParkedCount() const {
+        return parked.size();
+    }
+
+    /**
+     * @return The time the main thread waited for the job of the previous frame in milliseconds.
+     */
+    float getWaitTime() const {
+        return waitTime;
+    }
+
+private:
+    struct MeshData {
+        ResourceHandle<Mesh> handle; // Keeps the mesh alive while it is referenced by a job
+        std::vector<OcclusionCuller::Vertex> vertices;
+        std::vector<uint32_t> indices;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    struct Instance {
+        const MeshData *mesh;
+        float model[16];
+    };
+
+    struct Frame {
+        OcclusionCuller::View view;
+        std::vector<Instance> occluders;
+        std::vector<OcclusionCuller::Object> objects;
+        std::vector<Entity> objectEntities;
+    };
+
+    struct Result {
+        std::vector<Entity> occluded;
+        OcclusionCuller::Stats stats;
+    };
+
+    std::vector<Entity> finishJob() {
+        if (!pending.valid())
+            return {};
+        auto result = pending.get();
+        stats = result.stats;
+        return std::move(result.occluded);
+    }
+
+    Result run() {
+        culler.begin(frame.view);
+        for (auto &occluder: frame.occluders) {
+            culler.addOccluder(occluder.mesh->vertices.data(),
+                               occluder.mesh->vertices.size(),
+                               occluder.mesh->indices.data(),
+                               occluder.mesh->indices.size(),
+                               occluder.model);
+        }
+        culler.render();
+
+        occluded.resize(frame.objects.size());
+        culler.testObjects(frame.objects.data(), frame.objects.size(), occluded.data());
+
+        Result ret;
+        for (size_t i = 0; i < occluded.size(); i++) {
+            if (occluded[i])
+                ret.occluded.emplace_back(frame.objectEntities[i]);
+        }
+        ret.stats = culler.getStats();
+        return ret;
+    }
+
+    void apply(const std::vector<Entity> &occluded, ComponentManager &componentManager) {
+        std::set<Entity> hidden(occluded.begin(), occluded.end());
+
+        for (auto it = parked.begin(); it != parked.end();) {
+            if (hidden.find(it->first) == hidden.end()) {
+                componentManager.create<MeshRenderComponent>(it->first, it->second);
+                it = parked.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        for (auto &entity: hidden) {
+            if (parked.find(entity) != parked.end() || !componentManager.check<MeshRenderComponent>(entity))
+                continue;
+            parked[entity] = componentManager.lookup<MeshRenderComponent>(entity);
+            componentManager.destroy<MeshRenderComponent>(entity);
+        }
+    }
+
+    void restoreAll(ComponentManager &componentManager) {
+        for (auto &pair: parked)
+            componentManager.create<MeshRenderComponent>(pair.first, pair.second);
+        parked.clear();
+    }
+
+    bool capture(EntityManager &entityManager) {
+        auto &componentManager = entityManager.getComponentManager();
+
+        auto &cameras = componentManager.getPool<CameraComponent>();
+        if (cameras.begin() == cameras.end())
+            return false;
+
+        auto cameraEntity = cameras.begin()->first;
+        auto &camera = cameras.begin()->second.camera;
+        auto cameraTransform = componentManager.lookup<TransformComponent>(cameraEntity).transform;
+
+        // The camera looks along negative z
+        auto position = cameraTransform.getPosition();
+        auto forward = cameraTransform.forward() * -1;
+        auto right = cameraTransform.left() * -1;
+        auto up = cameraTransform.up();
+
+        frame.view = {{position.x, position.y, position.z},
+                      {right.x,    right.y,    right.z},
+                      {up.x,       up.y,       up.z},
+                      {forward.x,  forward.y,  forward.z},
+                      camera.fov,
+                      camera.aspectRatio,
+                      camera.nearClip,
+                      camera.farClip};
+
+        frame.occluders.clear();
+        frame.objects.clear();
+        frame.objectEntities.clear();
+
+        for (auto &pair: componentManager.getPool<MeshRenderComponent>())
+            addInstance(entityManager, pair.first, pair.second);
+        for (auto &pair: parked)
+            addInstance(entityManager, pair.first, pair.second);
+
+        return !frame.occluders.empty();
+    }
+
+    void addInstance(EntityManager &entityManager, const Entity &entity, const MeshRenderComponent &component) {
+        auto &mesh = getMeshData(component.mesh);
+        if (occluders.find(entity) != occluders.end()) {
+            Instance instance{};
+            instance.mesh = &mesh;
+            getWorldMatrix(entityManager, entity, instance.model);
+            frame.occluders.emplace_back(instance);
+        } else {
+            OcclusionCuller::Object object{};
+            std::copy(mesh.boundsMin, mesh.boundsMin + 3, object.boundsMin);
+            std::copy(mesh.boundsMax, mesh.boundsMax + 3, object.boundsMax);
+            getWorldMatrix(entityManager, entity, object.model);
+            frame.objects.emplace_back(object);
+            frame.objectEntities.emplace_back(entity);
+        }
+    }
+
+    const MeshData &getMeshData(const ResourceHandle<Mesh> &handle) {
+        auto &mesh = handle.get();
+        auto it = meshes.find(&mesh);
+        if (it != meshes.end())
+            return it->second;
+
+        auto &data = meshes[&mesh];
+        data.handle = handle;
+        for (int i = 0; i < 3; i++) {
+            data.boundsMin[i] = mesh.vertices.empty() ? 0 : INFINITY;
+            data.boundsMax[i] = mesh.vertices.empty() ? 0 : -INFINITY;
+        }
+        for (auto &vertex: mesh.vertices) {
+            OcclusionCuller::Vertex v{{vertex.position.x, vertex.position.y, vertex.position.z},
+                                      {vertex.normal.x,   vertex.normal.y,   vertex.normal.z}};
+            for (int i = 0; i < 3; i++) {
+                data.boundsMin[i] = std::min(data.boundsMin[i], v.position[i]);
+                data.boundsMax[i] = std::max(data.boundsMax[i], v.position[i]);
+            }
+            data.vertices.emplace_back(v);
+        }
+        if (mesh.indexed) {
+            data.indices.assign(mesh.indices.begin(), mesh.indices.end());
+        } else {
+            for (size_t i = 0; i < mesh.vertices.size(); i++)
+                data.indices.emplace_back(static_cast<uint32_t>(i));
+        }
+        return data;
+    }
+
+    ThreadPool &pool;
+    OcclusionCuller culler;
+
+    bool enabled = true;
+    std::set<Entity> occluders;
+
+    std::map<const Mesh *, MeshData> meshes;
+    std::map<Entity, MeshRenderComponent> parked;
+
+    Frame frame;
+    std::vector<uint8_t> occluded;
+    std::future<Result> pending;
+
+    OcclusionCuller::Stats stats;
+    float waitTime = 0;
+};
+
+#endif //MANA_OCCLUSIONCULLINGSYSTEM_HPP
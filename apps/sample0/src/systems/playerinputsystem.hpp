@@ -21,118 +21,63 @@
 #define MANA_PLAYERINPUTSYSTEM_HPP
 
 #include "ecs/system.hpp"
-#include "math/normalize.hpp"
 
 #include "components/playercontrollercomponent.hpp"
 
+#include "input/actionmapper.hpp"
+
 using namespace xengine;
 
 class PlayerInputSystem : public System {
 public:
-    explicit PlayerInputSystem(Input &input) : input(input) {};
+    explicit PlayerInputSystem(const InputActions &actions) : actions(actions) {};
 
     ~PlayerInputSystem() override = default;
 
     void update(float deltaTime, EntityManager &entityManager) override {
-        auto movement = getMovementInput();
-        auto rotation = getRotationInput();
-
         auto &componentManager = entityManager.getComponentManager();
         for (auto &pair: componentManager.getPool<PlayerControllerComponent>()) {
             auto transform = componentManager.lookup<TransformComponent>(pair.first);
+            applyInput(transform.transform, pair.second, actions, deltaTime);
+            componentManager.update<TransformComponent>(pair.first, transform);
+        }
+    }
 
-            // Invert forward vector because camera is facing in the negative z
-            Vec3f forward = transform.transform.forward() * -1;
-            Vec3f left = transform.transform.left();
-            Vec3f up = transform.transform.up();
-
-            Vec3f relativeMovement = forward * movement.z + left * movement.x + up * movement.y;
+    // Also used by the native InputController script which moves the scripted camera.
+    static void applyInput(Transform &transform,
+                           const PlayerControllerComponent &controller,
+                           const InputActions &actions,
+                           float deltaTime) {
+        auto &movement = actions.movement;
+        auto &rotation = actions.rotation;
 
-            Vec3f worldRot(0, rotation.y, 0);
-            Vec3f localRot(rotation.x, 0, 0);
+        float movementScale = 1.0f;
+        if (actions.boost)
+            movementScale = 5.0f;
 
-            float movementScale = 1.0f;
-            if (input.getKeyboards().at(0).getKey(KeyboardKey::KEY_LSHIFT))
-                movementScale = 5.0f;
+        // Invert forward vector because camera is facing in the negative z
+        Vec3f forward = transform.forward() * -1;
+        Vec3f left = transform.left();
+        Vec3f up = transform.up();
 
-            auto worldMov = relativeMovement * pair.second.movementSpeed * movementScale * deltaTime;
+        Vec3f relativeMovement = forward * movement.z + left * movement.x + up * movement.y;
 
-            //Apply the world movement
-            transform.transform.setPosition(transform.transform.getPosition() + worldMov);
+        Vec3f worldRot(0, rotation.y, 0);
+        Vec3f localRot(rotation.x, 0, 0);
 
-            //Apply the world rotation by converting it to a quaternion and using it as multiplier
-            transform.transform.applyRotation(Quaternion(worldRot * pair.second.rotationSpeed * deltaTime), true);
-            transform.transform.applyRotation(Quaternion(localRot * pair.second.rotationSpeed * deltaTime));
+        auto worldMov = relativeMovement * controller.movementSpeed * movementScale * deltaTime;
 
-            componentManager.update<TransformComponent>(pair.first, transform);
-        }
-    }
+        //Apply the world movement
+        transform.setPosition(transform.getPosition() + worldMov);
 
-    void setStickDeadZone(float value) {
-        deadzone = value;
+        //Apply the world rotation by converting it to a quaternion and using it as multiplier
+        transform.applyRotation(Quaternion(worldRot * controller.rotationSpeed * deltaTime), true);
+        transform.applyRotation(Quaternion(localRot * controller.rotationSpeed * deltaTime));
     }
 
 private:
-    Input &input;
-
-    double deadzone = 0.1f;
-
-    float applyDeadzone(float value) const {
-        if (value < deadzone && value > -deadzone) {
-            return 0;
-        } else {
-            return value;
-        }
-    }
-
-    Vec3f getMovementInput() {
-        Vec3f ret;
-        auto kb = input.getKeyboards().at(0);
-        if (kb.getKey(KEY_W))
-            ret.z = 1;
-        else if (kb.getKey(KEY_S))
-            ret.z = -1;
-        if (kb.getKey(KEY_A))
-            ret.x = 1;
-        else if (kb.getKey(KEY_D))
-            ret.x = -1;
-        if (kb.getKey(KEY_E))
-            ret.y = 1;
-        else if (kb.getKey(KEY_Q))
-            ret.y = -1;
-
-        auto pads = input.getGamePads();
-        for (auto &pad: input.getGamePads()) {
-            ret.x += applyDeadzone(pad.second.getGamepadAxis(LEFT_X) * -1);
-            ret.z += applyDeadzone(pad.second.getGamepadAxis(LEFT_Y) * -1);
-            if (pad.second.getGamepadButton(BUMPER_LEFT)) {
-                ret.y = -1;
-            } else if (pad.second.getGamepadButton(BUMPER_RIGHT)) {
-                ret.y = 1;
-            }
-        }
-        return normalize(ret);
-    }
-
-    Vec3f getRotationInput() {
-        Vec3f ret;
-
-        auto kb = input.getKeyboards().at(0);
-        if (kb.getKey(KEY_UP))
-            ret.x = 1;
-        else if (kb.getKey(KEY_DOWN))
-            ret.x = -1;
-        if (kb.getKey(KEY_LEFT))
-            ret.y = -1;
-        else if (kb.getKey(KEY_RIGHT))
-            ret.y = 1;
-
-        for (auto &pad: input.getGamePads()) {
-            ret.x += applyDeadzone(pad.second.getGamepadAxis(RIGHT_Y) * -1);
-            ret.y += applyDeadzone(pad.second.getGamepadAxis(RIGHT_X));
-        }
-        return normalize(ret);
-    }
+    // Resolved once per frame by the ActionMapper before the ECS is updated
+    const InputActions &actions;
 };
 
 #endif //MANA_PLAYERINPUTSYSTEM_HPP
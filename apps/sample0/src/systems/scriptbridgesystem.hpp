@@ -0,0 +1,151 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_SCRIPTBRIDGESYSTEM_HPP
+#define MANA_SCRIPTBRIDGESYSTEM_HPP
+
+#include <chrono>
+#include <cstring>
+
+#include "ecs/system.hpp"
+
+#include "scripting/scriptbatch.hpp"
+
+using namespace xengine;
+
+// Drives the script_mono and sync_mono components through a ScriptBatcher,
+// so a frame costs one runtime transition per script class and two for the component sync
+// instead of one per scripted entity and two per synced entity.
+class ScriptBridgeSystem : public System {
+public:
+    explicit ScriptBridgeSystem(ScriptRuntime &runtime)
+            : runtime(runtime) {}
+
+    void update(float deltaTime, EntityManager &entityManager) override {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        auto &componentManager = entityManager.getComponentManager();
+
+        batcher.begin();
+
+        for (auto &pair: componentManager.getPool<MonoScriptComponent>()) {
+            auto &script = pair.second;
+            auto scriptClass = script.assembly + ":";
+            if (!script.nameSpace.empty())
+                scriptClass += script.nameSpace + ".";
+            scriptClass += script.className;
+
+            pack(batcher.add(pair.first.id,
+                             scriptClass,
+                             script.queue,
+                             componentManager.check<MonoSyncComponent>(pair.first)),
+                 componentManager,
+                 pair.first);
+        }
+
+        for (auto &pair: componentManager.getPool<MonoSyncComponent>()) {
+            if (componentManager.check<MonoScriptComponent>(pair.first))
+                continue;
+            pack(batcher.add(pair.first.id, "", 0, true), componentManager, pair.first);
+        }
+
+        batcher.dispatch(runtime, deltaTime);
+
+        // Write back the synced transforms which the scripts changed
+        auto &entities = batcher.getEntities();
+        for (size_t i = 0; i < entities.size(); i++) {
+            if (!batcher.isSynced(i))
+                continue;
+
+            auto &data = entities.at(i);
+
+            Entity entity;
+            entity.id = data.entity;
+            if (!componentManager.check<TransformComponent>(entity))
+                continue;
+
+            auto transform = componentManager.lookup<TransformComponent>(entity);
+
+            ScriptEntityData current{};
+            current.entity = data.entity;
+            packTransform(current, transform.transform);
+            if (std::memcmp(&current, &data, sizeof(ScriptEntityData)) == 0)
+                continue;
+
+            unpackTransform(transform.transform, data);
+            componentManager.update<TransformComponent>(entity, transform);
+        }
+
+        bridgeTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    ScriptBatcher &getBatcher() {
+        return batcher;
+    }
+
+    const ScriptBatcher::Stats &getStats() const {
+        return batcher.getStats();
+    }
+
+    /**
+     * @return The time spent in the last update in milliseconds, including the script calls.
+     */
+    float getBridgeTime() const {
+        return bridgeTime;
+    }
+
+    static void packTransform(ScriptEntityData &data, const Transform &transform) {
+        auto &position = transform.getPosition();
+        auto rotation = transform.getRotation();
+        auto &scale = transform.getScale();
+        data.position[0] = position.x;
+        data.position[1] = position.y;
+        data.position[2] = position.z;
+        data.rotation[0] = rotation.w;
+        data.rotation[1] = rotation.x;
+        data.rotation[2] = rotation.y;
+        data.rotation[3] = rotation.z;
+        data.scale[0] = scale.x;
+        data.scale[1] = scale.y;
+        data.scale[2] = scale.z;
+    }
+
+    static void unpackTransform(Transform &transform, const ScriptEntityData &data) {
+        transform.setPosition(Vec3f(data.position[0], data.position[1], data.position[2]));
+        transform.setRotation(Quaternion(data.rotation[0], data.rotation[1], data.rotation[2], data.rotation[3]));
+        transform.setScale(Vec3f(data.scale[0], data.scale[1], data.scale[2]));
+    }
+
+private:
+    static void pack(ScriptEntityData &data, ComponentManager &componentManager, const Entity &entity) {
+        if (componentManager.check<TransformComponent>(entity)) {
+            packTransform(data, componentManager.lookup<TransformComponent>(entity).transform);
+        } else {
+            auto id = data.entity;
+            data = {};
+            data.entity = id;
+        }
+    }
+
+    ScriptRuntime &runtime;
+    ScriptBatcher batcher;
+    float bridgeTime = 0;
+};
+
+#endif //MANA_SCRIPTBRIDGESYSTEM_HPP
@@ -0,0 +1,292 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_STREAMINGAUDIOSYSTEM_HPP
+#define MANA_STREAMINGAUDIOSYSTEM_HPP
+
+#include <algorithm>
+#include <map>
+#include <deque>
+#include <cmath>
+
+#include "ecs/system.hpp"
+
+#include "audio/audiostream.hpp"
+#include "audio/voicemanager.hpp"
+#include "components/streamingaudiosourcecomponent.hpp"
+
+using namespace xengine;
+
+// Plays StreamingAudioSourceComponent's by feeding a ring of device buffers from a background decoded AudioStream.
+// Only the sources selected by the VoiceManager hold a device voice, the others are virtual and only advance their playback clock.
+class StreamingAudioSystem : public System {
+public:
+    StreamingAudioSystem(AudioDevice &device, Archive &archive)
+            : archive(archive),
+              context(device.createContext()) {}
+
+    ~StreamingAudioSystem() override = default;
+
+    void update(float deltaTime, EntityManager &entityManager) override {
+        auto &componentManager = entityManager.getComponentManager();
+
+        context->makeCurrent();
+
+        Vec3f listenerPosition;
+        for (auto &pair: componentManager.getPool<AudioListenerComponent>()) {
+            auto transform = componentManager.lookup<TransformComponent>(pair.first);
+            listenerPosition = transform.transform.getPosition();
+            context->getListener().setPosition(listenerPosition);
+            break;
+        }
+
+        frame++;
+
+        candidates.clear();
+        candidateEntities.clear();
+
+        for (auto &pair: componentManager.getPool<StreamingAudioSourceComponent>()) {
+            auto &comp = pair.second;
+            auto it = playbacks.find(pair.first);
+
+            if (!comp.play) {
+                if (it != playbacks.end())
+                    release(it);
+                continue;
+            }
+
+            if (it == playbacks.end()) {
+                it = playbacks.emplace(pair.first, createPlayback(comp)).first;
+            }
+
+            auto &playback = it->second;
+            playback.frame = frame;
+
+            if (playback.finished)
+                continue;
+
+            // Every playing source advances its clock, virtual sources resume at the correct position.
+            playback.time += deltaTime;
+            if (playback.time >= playback.duration) {
+                if (comp.loop && playback.duration > 0) {
+                    playback.time = std::fmod(playback.time, playback.duration);
+                } else {
+                    playback.finished = true;
+                    releaseVoice(playback);
+                    continue;
+                }
+            }
+
+            auto transform = componentManager.lookup<TransformComponent>(pair.first);
+            playback.position = transform.transform.getPosition();
+
+            auto delta = playback.position - listenerPosition;
+
+            VoiceManager::Candidate candidate;
+            candidate.distance = std::sqrt(delta.x * delta.x + delta.y * delta.y + delta.z * delta.z);
+            candidate.volume = comp.volume;
+            candidate.priority = comp.priority;
+            candidate.active = playback.voice != nullptr;
+            candidates.emplace_back(candidate);
+            candidateEntities.emplace_back(pair.first);
+        }
+
+        voiceManager.update(candidates);
+
+        for (size_t i = 0; i < candidates.size(); i++) {
+            auto &playback = playbacks.at(candidateEntities.at(i));
+            const auto &comp = componentManager.lookup<StreamingAudioSourceComponent>(candidateEntities.at(i));
+
+            if (!candidates.at(i).active) {
+                releaseVoice(playback);
+                continue;
+            }
+
+            if (!playback.voice)
+                playback.voice = createVoice(comp, playback);
+
+            playback.voice->source->setPosition(playback.position);
+            playback.voice->source->setGain(comp.volume);
+
+            updateVoice(*playback.voice);
+        }
+
+        // Release playbacks whose entity or component was destroyed
+        for (auto it = playbacks.begin(); it != playbacks.end();) {
+            if (it->second.frame != frame) {
+                release(it++);
+            } else {
+                it++;
+            }
+        }
+    }
+
+    // The total number of times a playing source ran out of decoded data.
+    unsigned long getUnderruns() const {
+        unsigned long ret = underruns;
+        for (auto &pair: playbacks) {
+            if (pair.second.voice)
+                ret += pair.second.voice->stream->getUnderruns();
+        }
+        return ret;
+    }
+
+    // The memory held by the decode rings of all active voices.
+    size_t getResidentBytes() const {
+        size_t ret = 0;
+        for (auto &pair: playbacks) {
+            if (pair.second.voice)
+                ret += pair.second.voice->stream->getResidentBytes();
+        }
+        return ret;
+    }
+
+
+    VoiceManager &getVoiceManager() {
+        return voiceManager;
+    }
+
+private:
+    struct Voice {
+        std::unique_ptr<AudioStream> stream;
+        std::vector<std::unique_ptr<AudioBuffer>> buffers;
+        std::unique_ptr<AudioSource> source; // Declared after the buffers so that it is destroyed while they still exist
+        std::deque<AudioBuffer *> queued; // Device buffers in playback order
+        std::vector<AudioBuffer *> free;
+        AudioFormat format;
+        bool started = false;
+        bool starved = false; // The device drained all buffers, counted once until playback resumes
+    };
+
+    struct Playback {
+        double time = 0; // Playback position in seconds
+        double duration = 0;
+        bool finished = false;
+        Vec3f position;
+        std::unique_ptr<Voice> voice; // Null while the playback is virtual
+        unsigned long frame = 0;
+    };
+
+    static AudioFormat getFormat(const WavStream &wav) {
+        if (wav.getChannels() == 1)
+            return wav.getBitsPerSample() == 8 ? MONO8 : MONO16;
+        else
+            return wav.getBitsPerSample() == 8 ? STEREO8 : STEREO16;
+    }
+
+    Playback createPlayback(const StreamingAudioSourceComponent &comp) {
+        // Only the header is parsed here, the stream is reopened once the playback gets a voice.
+        WavStream wav(archive.open(comp.path));
+        Playback ret;
+        ret.duration = static_cast<double>(wav.getFrameCount()) / wav.getSampleRate();
+        return ret;
+    }
+
+    std::unique_ptr<Voice> createVoice(const StreamingAudioSourceComponent &comp, const Playback &playback) {
+        auto wav = std::make_unique<WavStream>(archive.open(comp.path));
+        wav->seek(static_cast<size_t>(playback.time * wav->getSampleRate()));
+
+        auto ret = std::make_unique<Voice>();
+        ret->format = getFormat(*wav);
+        ret->stream = std::make_unique<AudioStream>(std::move(wav),
+                                                    static_cast<size_t>(std::max(comp.bufferCount, 2)),
+                                                    comp.chunkSize,
+                                                    comp.loop);
+        ret->source = context->createSource();
+        for (size_t i = 0; i < ret->stream->getBufferCount(); i++) {
+            ret->buffers.emplace_back(context->createBuffer());
+            ret->free.emplace_back(ret->buffers.back().get());
+        }
+        return ret;
+    }
+
+    // Virtualize the playback by returning its device voice.
+    // The source is stopped and detached from its buffers before either is destroyed.
+    void releaseVoice(Playback &playback) {
+        if (playback.voice) {
+            auto &voice = *playback.voice;
+            voice.source->stop();
+            for (auto *buffer: voice.queued)
+                voice.source->unqueueBuffers({*buffer});
+            voice.queued.clear();
+            underruns += voice.stream->getUnderruns();
+            playback.voice = nullptr;
+        }
+    }
+
+    void release(std::map<Entity, Playback>::iterator it) {
+        releaseVoice(it->second);
+        playbacks.erase(it);
+    }
+
+    void updateVoice(Voice &voice) {
+        auto &stream = *voice.stream;
+
+        int processed = voice.source->getBuffersProcessed();
+        for (int i = 0; i < processed && !voice.queued.empty(); i++) {
+            auto *buffer = voice.queued.front();
+            voice.queued.pop_front();
+            voice.source->unqueueBuffers({*buffer});
+            voice.free.emplace_back(buffer);
+        }
+
+        while (!voice.free.empty()) {
+            auto *chunk = stream.front();
+            if (chunk == nullptr)
+                break;
+
+            auto *buffer = voice.free.back();
+            voice.free.pop_back();
+
+            buffer->upload(std::vector<uint8_t>(chunk->data.begin(), chunk->data.begin() + chunk->size),
+                           voice.format,
+                           stream.getSource().getSampleRate());
+            stream.pop();
+
+            voice.source->queueBuffers({*buffer});
+            voice.queued.emplace_back(buffer);
+        }
+
+        if (!voice.source->isPlaying()) {
+            // The device drained every queued buffer before the decoder delivered the next chunk.
+            if (voice.started && !voice.starved && !stream.finished()) {
+                stream.countUnderrun();
+                voice.starved = true;
+            }
+            if (!voice.queued.empty()) {
+                voice.source->play();
+                voice.started = true;
+                voice.starved = false;
+            }
+        }
+    }
+
+    Archive &archive;
+    std::unique_ptr<AudioContext> context;
+
+    VoiceManager voiceManager;
+    std::vector<VoiceManager::Candidate> candidates;
+    std::vector<Entity> candidateEntities;
+
+    std::map<Entity, Playback> playbacks;
+    unsigned long frame = 0;
+    unsigned long underruns = 0; // Underruns of voices which were already released
+};
+
+#endif //MANA_STREAMINGAUDIOSYSTEM_HPP
@@ -0,0 +1,60 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_TAGGEDSYSTEM_HPP
+#define MANA_TAGGEDSYSTEM_HPP
+
+#include <memory>
+
+#include "ecs/system.hpp"
+
+#include "memory/allocationtracker.hpp"
+
+using namespace xengine;
+
+// Wraps a system and attributes its allocations to an AllocationTag.
+class TaggedSystem : public System {
+public:
+    // Takes ownership of the system, like the ECS does for the systems passed to it.
+    TaggedSystem(AllocationTag tag, System *system)
+            : tag(tag), system(system) {}
+
+    ~TaggedSystem() override = default;
+
+    void start(EntityManager &entityManager) override {
+        AllocationScope scope(tag);
+        system->start(entityManager);
+    }
+
+    void stop(EntityManager &entityManager) override {
+        AllocationScope scope(tag);
+        system->stop(entityManager);
+    }
+
+    void update(float deltaTime, EntityManager &entityManager) override {
+        AllocationScope scope(tag);
+        system->update(deltaTime, entityManager);
+    }
+
+private:
+    AllocationTag tag;
+    std::unique_ptr<System> system;
+};
+
+#endif //MANA_TAGGEDSYSTEM_HPP
@@ -0,0 +1,300 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MANA_TEXTURESTREAMINGSYSTEM_HPP
+#define MANA_TEXTURESTREAMINGSYSTEM_HPP
+
+#include <map>
+#include <mutex>
+#include <regex>
+#include <iterator>
+#include <filesystem>
+#include <cmath>
+#include <limits>
+
+#include "ecs/system.hpp"
+
+#include "render/texturestreamer.hpp"
+#include "concurrency/threadpool.hpp"
+
+#include "math/worldtransform.hpp"
+#include "io/compressedarchive.hpp"
+
+#include "memory/allocationtracker.hpp"
+
+using namespace xengine;
+
+// Streams the textures referenced by the materials of the mesh render components.
+// The texture paths are taken from the material bundles, every texture starts with the coarse tail of its
+// mip chain resident and is requested each frame with the screen size of the largest visible mesh using it,
+// assuming the texture is mapped once over the bounds of the mesh.
+// The finest resident level of every texture is kept uploaded in a texture buffer owned by this system.
+class TextureStreamingSystem : public System {
+public:
+    TextureStreamingSystem(ThreadPool &pool, Archive &archive, RenderDevice &device, size_t budget)
+            : archive(archive), device(device), streamer(pool, budget) {
+        streamer.setUploadCallback([this](int id, int mip) {
+            uploadLevel(id, mip);
+        });
+    }
+
+    void setViewportHeight(int value) {
+        viewportHeight = value;
+    }
+
+    void setBudget(size_t value) {
+        streamer.setBudget(value);
+    }
+
+    void update(float deltaTime, EntityManager &entityManager) override {
+        auto &componentManager = entityManager.getComponentManager();
+
+        auto &cameras = componentManager.getPool<CameraComponent>();
+        if (cameras.begin() != cameras.end()) {
+            auto cameraEntity = cameras.begin()->first;
+            auto &camera = cameras.begin()->second.camera;
+            auto cameraTransform = componentManager.lookup<TransformComponent>(cameraEntity).transform;
+
+            // Pixels per world unit at a distance of one
+            auto scale = static_cast<float>(viewportHeight) / (2 * std::tan(camera.fov * 0.5f * M_PI / 180.0f));
+
+            for (auto &pair: componentManager.getPool<MeshRenderComponent>()) {
+                auto &textures = getTextures(pair.second.material);
+                if (textures.empty())
+                    continue;
+                auto pixels = getProjectedSize(entityManager, pair.first, pair.second, cameraTransform, scale);
+                if (pixels <= 0)
+                    continue;
+                for (auto id: textures)
+                    streamer.request(id, pixels);
+            }
+        }
+
+        streamer.update();
+    }
+
+    const TextureStreamer::Stats &getStats() const {
+        return streamer.getStats();
+    }
+
+    /**
+     * @return The texture buffer holding the finest resident level of the texture or nullptr if nothing is resident.
+     */
+    TextureBuffer *getTextureBuffer(const std::string &path) {
+        auto it = ids.find(path);
+        if (it == ids.end())
+            return nullptr;
+        auto &buffer = buffers.at(static_cast<size_t>(it->second));
+        return buffer.texture.get();
+    }
+
+private:
+    struct Buffer {
+        std::unique_ptr<TextureBuffer> texture;
+        int mip = TextureStreamer::NOT_RESIDENT;
+    };
+
+    struct Bounds {
+        ResourceHandle<Mesh> handle; // Keeps the mesh alive while it is referenced in the cache
+        float center[3];
+        float radius;
+    };
+
+    const std::vector<int> &getTextures(const ResourceHandle<Material> &material) {
+        auto &file = material.getUri().file;
+        auto it = materials.find(file);
+        if (it != materials.end())
+            return it->second;
+
+        auto &ret = materials[file];
+        std::string text;
+        {
+            std::lock_guard<std::mutex> guard(archiveMutex);
+            if (!archive.exists(file))
+                return ret;
+            auto stream = archive.open(file);
+            text = std::string(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+        }
+
+        // Any string value in the bundle naming an image file, relative paths are relative to the bundle
+        static const std::regex imagePath(R"re("([^"]+\.(png|jpg|jpeg|tga|bmp))")re", std::regex::icase);
+        for (auto match = std::sregex_iterator(text.begin(), text.end(), imagePath);
+             match != std::sregex_iterator();
+             match++) {
+            auto path = (*match)[1].str();
+            if (path.front() != '/')
+                path = std::filesystem::path(file).parent_path().append(path).generic_string();
+            ret.emplace_back(getTexture(path));
+        }
+        return ret;
+    }
+
+    int getTexture(const std::string &path) {
+        auto it = ids.find(path);
+        if (it != ids.end())
+            return it->second;
+
+        auto id = streamer.add([this, path]() {
+            return loadImage(path);
+        });
+        ids[path] = id;
+        buffers.resize(static_cast<size_t>(id) + 1);
+        return id;
+    }
+
+    // Called on a worker thread, the archive is only locked while reading the file.
+    TextureStreamer::Image loadImage(const std::string &path) {
+        AllocationScope scope(ALLOC_RESOURCES);
+
+        std::vector<char> data;
+        {
+            std::lock_guard<std::mutex> guard(archiveMutex);
+            if (!archive.exists(path))
+                return {};
+            auto stream = archive.open(path);
+            data.assign(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+        }
+
+        MemoryStream stream(std::move(data));
+        auto bundle = ResourceImporter().import(stream, std::filesystem::path(path).extension().string());
+        auto &image = bundle.get<Texture>().image;
+
+        TextureStreamer::Image ret;
+        ret.width = image.getWidth();
+        ret.height = image.getHeight();
+        ret.pixels.resize(static_cast<size_t>(ret.width) * static_cast<size_t>(ret.height) * 4);
+        auto *out = ret.pixels.data();
+        for (int y = 0; y < ret.height; y++) {
+            for (int x = 0; x < ret.width; x++) {
+                auto pixel = image.getPixel(x, y);
+                *out++ = pixel.r();
+                *out++ = pixel.g();
+                *out++ = pixel.b();
+                *out++ = pixel.a();
+            }
+        }
+        return ret;
+    }
+
+    void uploadLevel(int id, int mip) {
+        auto &buffer = buffers.at(static_cast<size_t>(id));
+        if (buffer.mip == mip)
+            return;
+
+        auto &level = streamer.getLevel(id, mip);
+        ImageRGBA image(level.width, level.height);
+        auto *in = level.pixels.data();
+        for (int y = 0; y < level.height; y++) {
+            for (int x = 0; x < level.width; x++) {
+                image.setPixel(x, y, ColorRGBA(in[0], in[1], in[2], in[3]));
+                in += 4;
+            }
+        }
+
+        TextureBuffer::Attributes attributes;
+        attributes.size = Vec2i(level.width, level.height);
+        buffer.texture = device.getAllocator().createTextureBuffer(attributes);
+        buffer.texture->upload(image);
+        buffer.mip = mip;
+    }
+
+    /**
+     * @return The diameter of the bounding sphere of the mesh on screen in pixels, 0 if it is behind the camera.
+     */
+    float getProjectedSize(EntityManager &entityManager,
+                           const Entity &entity,
+                           const MeshRenderComponent &component,
+                           const Transform &camera,
+                           float scale) {
+        auto &bounds = getBounds(component.mesh);
+
+        float model[16];
+        getWorldMatrix(entityManager, entity, model);
+
+        float center[3];
+        float axisScale = 0;
+        for (int r = 0; r < 3; r++) {
+            center[r] = model[r] * bounds.center[0]
+                        + model[4 + r] * bounds.center[1]
+                        + model[8 + r] * bounds.center[2]
+                        + model[12 + r];
+            auto c = r * 4;
+            axisScale = std::max(axisScale, std::sqrt(model[c] * model[c]
+                                                      + model[c + 1] * model[c + 1]
+                                                      + model[c + 2] * model[c + 2]));
+        }
+        auto radius = bounds.radius * axisScale;
+
+        auto position = camera.getPosition();
+        float delta[3] = {center[0] - position.x, center[1] - position.y, center[2] - position.z};
+        auto distance = std::sqrt(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+        if (distance <= radius)
+            return std::numeric_limits<float>::max(); // The camera is inside the bounds
+
+        // The camera looks along negative z
+        auto forward = camera.forward() * -1;
+        if (delta[0] * forward.x + delta[1] * forward.y + delta[2] * forward.z < -radius)
+            return 0;
+
+        return 2 * radius / distance * scale;
+    }
+
+    const Bounds &getBounds(const ResourceHandle<Mesh> &handle) {
+        auto &mesh = handle.get();
+        auto it = meshBounds.find(&mesh);
+        if (it != meshBounds.end())
+            return it->second;
+
+        float min[3] = {0, 0, 0};
+        float max[3] = {0, 0, 0};
+        for (size_t i = 0; i < mesh.vertices.size(); i++) {
+            auto &p = mesh.vertices[i].position;
+            float v[3] = {p.x, p.y, p.z};
+            for (int c = 0; c < 3; c++) {
+                min[c] = i == 0 ? v[c] : std::min(min[c], v[c]);
+                max[c] = i == 0 ? v[c] : std::max(max[c], v[c]);
+            }
+        }
+
+        auto &ret = meshBounds[&mesh];
+        ret.handle = handle;
+        float radius = 0;
+        for (int c = 0; c < 3; c++) {
+            ret.center[c] = (min[c] + max[c]) * 0.5f;
+            radius += (max[c] - min[c]) * (max[c] - min[c]) * 0.25f;
+        }
+        ret.radius = std::sqrt(radius);
+        return ret;
+    }
+
+    Archive &archive;
+    RenderDevice &device;
+    std::mutex archiveMutex;
+
+    TextureStreamer streamer;
+
+    int viewportHeight = 1080;
+
+    std::map<std::string, std::vector<int>> materials;
+    std::map<std::string, int> ids;
+    std::vector<Buffer> buffers;
+    std::map<const Mesh *, Bounds> meshBounds;
+};
+
+#endif //MANA_TEXTURESTREAMINGSYSTEM_HPP
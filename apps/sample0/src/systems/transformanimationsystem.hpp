@@ -21,25 +21,68 @@
 #define MANA_TRANSFORMANIMATIONSYSTEM_HPP
 
 
+#include <vector>
+
 #include "ecs/system.hpp"
 
 #include "components/transformanimationcomponent.hpp"
 
+#include "math/transformstreams.hpp"
+
 using namespace xengine;
 
+// Gathers the animated transforms into streams so that the integration runs in the bulk kernels,
+// the streams are members to keep their capacity across frames.
 class TransformAnimationSystem : public System {
 public:
     void update(float deltaTime, EntityManager &entityManager) override {
         auto &componentManager = entityManager.getComponentManager();
+
+        entities.clear();
+        position.clear();
+        rotation.clear();
+        translation.clear();
+        angularVelocity.clear();
         for (auto &pair: componentManager.getPool<TransformAnimationComponent>()) {
-            auto transform = componentManager.lookup<TransformComponent>(pair.first);
+            auto transform = componentManager.lookup<TransformComponent>(pair.first).transform;
+            auto p = transform.getPosition();
+            auto r = transform.getRotation();
+            entities.emplace_back(pair.first);
+            position.push_back(p.x, p.y, p.z);
+            rotation.push_back(r.x, r.y, r.z, r.w);
+            translation.push_back(pair.second.translation.x,
+                                  pair.second.translation.y,
+                                  pair.second.translation.z);
+            angularVelocity.push_back(pair.second.rotation.x,
+                                      pair.second.rotation.y,
+                                      pair.second.rotation.z);
+        }
 
-            transform.transform.setPosition(transform.transform.getPosition() + pair.second.translation * deltaTime);
-            transform.transform.setRotation(transform.transform.getRotation() * Quaternion(pair.second.rotation * deltaTime));
+        TransformKernels::addScaled(position, translation, deltaTime);
+        TransformKernels::quaternionFromEuler(angularVelocity, deltaTime, delta);
+        TransformKernels::quaternionMultiply(rotation, delta, rotation);
+        TransformKernels::quaternionNormalize(rotation);
 
-            componentManager.update<TransformComponent>(pair.first, transform);
+        for (size_t i = 0; i < entities.size(); i++) {
+            auto transform = componentManager.lookup<TransformComponent>(entities.at(i));
+            auto r = transform.transform.getRotation();
+            r.x = rotation.x[i];
+            r.y = rotation.y[i];
+            r.z = rotation.z[i];
+            r.w = rotation.w[i];
+            transform.transform.setPosition(Vec3f(position.x[i], position.y[i], position.z[i]));
+            transform.transform.setRotation(r);
+            componentManager.update<TransformComponent>(entities.at(i), transform);
         }
     }
+
+private:
+    std::vector<Entity> entities;
+    Vec3Streams position;
+    QuaternionStreams rotation;
+    Vec3Streams translation;
+    Vec3Streams angularVelocity;
+    QuaternionStreams delta;
 };
 
 #endif //MANA_TRANSFORMANIMATIONSYSTEM_HPP
@@ -0,0 +1,264 @@
+/**
+ *  xEngine-Samples - Example applications demonstrating the xEngine
+ *  Copyright (C) 2021  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <map>
+#include <cstdlib>
+
+#include "xengine.hpp"
+
+#include "render/softrasterizer.hpp"
+#include "math/worldtransform.hpp"
+
+using namespace xengine;
+
+// Renders the first camera of a scene with the software rasterizer, without a window or gpu.
+//
+// Usage: xsamples_softrender [--assets <dir>] [--scene <path>] [--size <width> <height>] [--output <file.ppm>]
+//                            [--frames <count>] [--reference <file.ppm> [--tolerance <value>]]
+//
+// With --reference the image is compared against a previous render, for regression tests on machines without a gpu.
+// The exit code is 1 if the mean absolute difference per channel exceeds the tolerance and 2 if the reference
+// can not be read. References should be produced on the same cpu dispatch level (see XSAMPLES_CPU)
+// because the avx2 path may round differently.
+
+struct MeshData {
+    std::vector<SoftRasterizer::Vertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+static void toFloat3(const Vec3f &value, float out[3]) {
+    out[0] = value.x;
+    out[1] = value.y;
+    out[2] = value.z;
+}
+
+static void toFloat3(const ColorRGBA &color, float out[3]) {
+    out[0] = static_cast<float>(color.r()) / 255.0f;
+    out[1] = static_cast<float>(color.g()) / 255.0f;
+    out[2] = static_cast<float>(color.b()) / 255.0f;
+}
+
+static bool readPPM(const std::string &path, int &width, int &height, std::vector<uint8_t> &pixels) {
+    std::ifstream stream(path, std::ios::binary);
+    std::string magic;
+    int maxValue;
+    stream >> magic >> width >> height >> maxValue;
+    stream.get();
+    if (!stream || magic != "P6" || maxValue != 255 || width <= 0 || height <= 0)
+        return false;
+    pixels.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 3);
+    stream.read(reinterpret_cast<char *>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+    return static_cast<size_t>(stream.gcount()) == pixels.size();
+}
+
+int main(int argc, char *argv[]) {
+    std::string assets = "assets";
+    std::string scenePath = "/scene.json";
+    std::string output = "softrender.ppm";
+    std::string reference;
+    float tolerance = 1;
+    int width = 1280;
+    int height = 720;
+    int frames = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--assets" && hasValue)
+            assets = argv[++i];
+        else if (arg == "--scene" && hasValue)
+            scenePath = argv[++i];
+        else if (arg == "--output" && hasValue)
+            output = argv[++i];
+        else if (arg == "--reference" && hasValue)
+            reference = argv[++i];
+        else if (arg == "--tolerance" && hasValue) {
+            char *end;
+            tolerance = std::strtof(argv[++i], &end);
+            if (end == argv[i] || *end != 0 || !(tolerance >= 0)) {
+                std::cerr << "Invalid tolerance " << argv[i] << std::endl;
+                return 2;
+            }
+        } else if (arg == "--frames" && hasValue)
+            frames = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--size" && i + 2 < argc) {
+            width = std::stoi(argv[++i]);
+            height = std::stoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    auto archive = std::make_shared<DirectoryArchive>(assets);
+    ResourceRegistry::getDefaultRegistry().setArchive(archive);
+
+    auto sceneStream = archive->open(scenePath);
+    auto scene = JsonProtocol().deserialize(*sceneStream);
+
+    EntityManager entityManager;
+    entityManager << scene;
+    auto &componentManager = entityManager.getComponentManager();
+
+    SoftRasterizer rasterizer(width, height);
+    rasterizer.setClearColor(38.0f / 255.0f, 38.0f / 255.0f, 38.0f / 255.0f);
+
+    auto &cameras = componentManager.getPool<CameraComponent>();
+    if (cameras.begin() == cameras.end()) {
+        std::cerr << "The scene does not contain a camera" << std::endl;
+        return 2;
+    }
+
+    auto &camera = cameras.begin()->second.camera;
+    auto cameraTransform = componentManager.lookup<TransformComponent>(cameras.begin()->first).transform;
+
+    // The camera looks along negative z
+    SoftRasterizer::View view{};
+    toFloat3(cameraTransform.getPosition(), view.position);
+    toFloat3(cameraTransform.left() * -1, view.right);
+    toFloat3(cameraTransform.up(), view.up);
+    toFloat3(cameraTransform.forward() * -1, view.forward);
+    view.fovY = camera.fov;
+    view.aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+    view.nearClip = camera.nearClip;
+    view.farClip = camera.farClip;
+    rasterizer.setView(view);
+
+    std::vector<SoftRasterizer::Light> lights;
+    for (auto &pair: componentManager.getPool<LightComponent>()) {
+        auto &light = pair.second.light;
+        SoftRasterizer::Light l;
+        switch (light.type) {
+            case LIGHT_DIRECTIONAL:
+                l.kind = SoftRasterizer::DIRECTIONAL;
+                break;
+            case LIGHT_POINT:
+                l.kind = SoftRasterizer::POINT;
+                break;
+            case LIGHT_SPOT:
+                l.kind = SoftRasterizer::SPOT;
+                break;
+        }
+        toFloat3(componentManager.lookup<TransformComponent>(pair.first).transform.getPosition(), l.position);
+        toFloat3(light.direction, l.direction);
+        toFloat3(light.ambient, l.ambient);
+        toFloat3(light.diffuse, l.diffuse);
+        toFloat3(light.specular, l.specular);
+        l.constant = light.constant;
+        l.linear = light.linear;
+        l.quadratic = light.quadratic;
+        // Cone angles are stored in degrees
+        l.cutOff = std::cos(light.cutOff * 3.14159265f / 180.0f);
+        l.outerCutOff = std::cos(light.outerCutOff * 3.14159265f / 180.0f);
+        lights.emplace_back(l);
+    }
+    rasterizer.setLights(lights);
+
+    // Textures are not sampled, materials contribute their colors only
+    std::map<const Mesh *, MeshData> meshes;
+    for (auto &pair: componentManager.getPool<MeshRenderComponent>()) {
+        auto &mesh = pair.second.mesh.get();
+        auto &material = pair.second.material.get();
+
+        auto &data = meshes[&mesh];
+        if (data.vertices.empty()) {
+            for (auto &vertex: mesh.vertices) {
+                SoftRasterizer::Vertex v{};
+                toFloat3(vertex.position, v.position);
+                toFloat3(vertex.normal, v.normal);
+                data.vertices.emplace_back(v);
+            }
+            if (mesh.indexed) {
+                data.indices.assign(mesh.indices.begin(), mesh.indices.end());
+            } else {
+                for (size_t i = 0; i < mesh.vertices.size(); i++)
+                    data.indices.emplace_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        SoftRasterizer::Material m;
+        toFloat3(material.ambient, m.ambient);
+        toFloat3(material.diffuse, m.diffuse);
+        toFloat3(material.specular, m.specular);
+        m.shininess = material.shininess;
+
+        float model[16];
+        getWorldMatrix(entityManager, pair.first, model);
+
+        rasterizer.draw(data.vertices.data(),
+                        data.vertices.size(),
+                        data.indices.data(),
+                        data.indices.size(),
+                        model,
+                        rasterizer.addMaterial(m));
+    }
+
+    float totalTime = 0;
+    for (int i = 0; i < frames; i++) {
+        rasterizer.render();
+        auto &stats = rasterizer.getStats();
+        totalTime += stats.vertexTime + stats.setupTime + stats.rasterTime;
+    }
+
+    auto &stats = rasterizer.getStats();
+    std::cout << "Draw calls: " << stats.drawCalls
+              << " Triangles: " << stats.triangles
+              << " Culled: " << stats.culledTriangles
+              << " Clipped: " << stats.clippedTriangles
+              << " Tile references: " << stats.tileReferences
+              << " Shaded pixels: " << stats.shadedPixels << std::endl;
+    std::cout << "Vertex: " << stats.vertexTime << "ms"
+              << " Setup: " << stats.setupTime << "ms"
+              << " Raster: " << stats.rasterTime << "ms"
+              << " Average frame: " << totalTime / static_cast<float>(frames) << "ms" << std::endl;
+
+    std::ofstream outputStream(output, std::ios::binary);
+    rasterizer.writePPM(outputStream);
+
+    if (!reference.empty()) {
+        int refWidth, refHeight;
+        std::vector<uint8_t> pixels;
+        if (!readPPM(reference, refWidth, refHeight, pixels)) {
+            std::cerr << "Failed to read reference image " << reference << std::endl;
+            return 2;
+        }
+        if (refWidth != width || refHeight != height) {
+            std::cerr << "Reference image is " << refWidth << "x" << refHeight
+                      << ", rendered " << width << "x" << height << std::endl;
+            return 1;
+        }
+
+        auto &color = rasterizer.getColor();
+        double difference = 0;
+        for (size_t i = 0; i < pixels.size(); i++)
+            difference += std::abs(static_cast<int>(pixels[i]) - static_cast<int>(color[i]));
+        difference /= static_cast<double>(pixels.size());
+
+        std::cout << "Mean absolute difference to reference: " << difference
+                  << " (tolerance " << tolerance << ")" << std::endl;
+        if (difference > tolerance)
+            return 1;
+    }
+
+    return 0;
+}
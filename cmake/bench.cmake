@@ -0,0 +1,20 @@
+find_package(benchmark QUIET)
+
+if (benchmark_FOUND)
+    file(GLOB_RECURSE XSamplesBench.SRC apps/bench/src/*.cpp apps/bench/src/*.c)
+    add_executable(xsamples_bench ${XSamplesBench.SRC} ${XSamplesCommon.SRC})
+    target_include_directories(xsamples_bench PRIVATE apps/bench/src/ apps/sample0/src/ apps/common/src/)
+    target_link_libraries(xsamples_bench xengine benchmark::benchmark ${XSamplesCompression.LIBS})
+    if (OpenMP_CXX_FOUND)
+        target_link_libraries(xsamples_bench OpenMP::OpenMP_CXX)
+    endif ()
+
+    # Writes bench.json into the binary directory, the reports of two builds can be compared with
+    # benchmark's tools/compare.py or any json diff.
+    add_custom_target(bench_json
+            COMMAND xsamples_bench --benchmark_out=${CMAKE_CURRENT_BINARY_DIR}/bench.json --benchmark_out_format=json
+            WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+            DEPENDS xsamples_bench)
+else ()
+    message("Google Benchmark not found, the xsamples_bench target is not available")
+endif ()
@@ -0,0 +1,45 @@
+#!/bin/sh
+# Builds the optimization profiles from cmake/profiles.cmake in separate build directories
+# and writes the benchmark report of each into <output>/bench-<profile>.json.
+#
+# Usage: cmake/buildprofiles.sh [output directory]
+
+set -e
+
+SOURCE_DIR=$(cd "$(dirname "$0")/.." && pwd)
+OUTPUT_DIR=$(mkdir -p "${1:-$SOURCE_DIR/profiles}" && cd "${1:-$SOURCE_DIR/profiles}" && pwd)
+JOBS=$(nproc 2>/dev/null || echo 4)
+
+build() {
+    NAME=$1
+    shift
+    cmake -S "$SOURCE_DIR" -B "$OUTPUT_DIR/build-$NAME" -DCMAKE_BUILD_TYPE=Release "$@"
+    cmake --build "$OUTPUT_DIR/build-$NAME" -j"$JOBS" --target xsamples_bench xsample0 assetexplorer
+}
+
+bench() {
+    NAME=$1
+    cmake --build "$OUTPUT_DIR/build-$NAME" --target bench_json
+    cp "$OUTPUT_DIR/build-$NAME/bench.json" "$OUTPUT_DIR/bench-$NAME.json"
+}
+
+build release
+bench release
+
+build lto -DXSAMPLES_LTO=ON
+bench lto
+
+build native -DXSAMPLES_LTO=ON -DXSAMPLES_ARCH=native
+bench native
+
+# The instrumented build records its profile while running the benchmark workload
+build pgo-generate -DXSAMPLES_LTO=ON -DXSAMPLES_PGO=GENERATE -DXSAMPLES_PGO_DIR="$OUTPUT_DIR/pgo"
+cmake --build "$OUTPUT_DIR/build-pgo-generate" --target bench_json
+if cmake --build "$OUTPUT_DIR/build-pgo-generate" --target help | grep -q pgo_merge; then
+    cmake --build "$OUTPUT_DIR/build-pgo-generate" --target pgo_merge
+fi
+
+build pgo -DXSAMPLES_LTO=ON -DXSAMPLES_PGO=USE -DXSAMPLES_PGO_DIR="$OUTPUT_DIR/pgo"
+bench pgo
+
+echo "Benchmark reports written to $OUTPUT_DIR"
@@ -0,0 +1,10 @@
+option(XSAMPLES_ALLOCATION_TRACKING "Track heap allocations per tag with global operator new / delete hooks" OFF)
+
+if (XSAMPLES_ALLOCATION_TRACKING)
+    add_compile_definitions(XSAMPLES_ALLOCATION_TRACKING)
+endif ()
+
+# Sources shared by all targets, added to each executable
+file(GLOB_RECURSE XSamplesCommon.SRC apps/common/src/*.cpp apps/common/src/*.c)
+
+include(cmake/compression.cmake)
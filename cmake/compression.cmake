@@ -0,0 +1,31 @@
+# Optional codecs for compressed pak entries, each one is compiled in when the library is found.
+# Paks written with a codec can only be read by builds which have the same codec.
+set(XSamplesCompression.LIBS "")
+set(XSamplesCompression.CODECS "none")
+
+find_package(ZLIB QUIET)
+if (ZLIB_FOUND)
+    add_compile_definitions(XSAMPLES_WITH_ZLIB)
+    list(APPEND XSamplesCompression.LIBS ZLIB::ZLIB)
+    list(APPEND XSamplesCompression.CODECS deflate)
+endif ()
+
+find_path(LZ4_INCLUDE_DIR lz4.h)
+find_library(LZ4_LIBRARY lz4)
+if (LZ4_INCLUDE_DIR AND LZ4_LIBRARY)
+    add_compile_definitions(XSAMPLES_WITH_LZ4)
+    include_directories(${LZ4_INCLUDE_DIR})
+    list(APPEND XSamplesCompression.LIBS ${LZ4_LIBRARY})
+    list(APPEND XSamplesCompression.CODECS lz4)
+endif ()
+
+find_path(ZSTD_INCLUDE_DIR zstd.h)
+find_library(ZSTD_LIBRARY zstd)
+if (ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+    add_compile_definitions(XSAMPLES_WITH_ZSTD)
+    include_directories(${ZSTD_INCLUDE_DIR})
+    list(APPEND XSamplesCompression.LIBS ${ZSTD_LIBRARY})
+    list(APPEND XSamplesCompression.CODECS zstd)
+endif ()
+
+message("Pak codecs: ${XSamplesCompression.CODECS}")
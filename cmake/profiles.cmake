@@ -0,0 +1,63 @@
+# Optimization profiles, the options can be combined.
+#
+#   XSAMPLES_LTO=ON                     Link time optimization of all targets.
+#   XSAMPLES_PGO=GENERATE               Instrumented build, run the workload (eg. the bench_json target or xsample0) to record profiles.
+#   XSAMPLES_PGO=USE                    Rebuild using the recorded profiles in XSAMPLES_PGO_DIR.
+#   XSAMPLES_ARCH=native|x86-64-v3|...  Value passed to -march, kernels with runtime dispatch still select their path at runtime.
+#
+# cmake/buildprofiles.sh builds every profile and writes the benchmark report of each.
+
+option(XSAMPLES_LTO "Enable link time optimization" OFF)
+set(XSAMPLES_PGO "OFF" CACHE STRING "Profile guided optimization stage (OFF, GENERATE, USE)")
+set_property(CACHE XSAMPLES_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(XSAMPLES_PGO_DIR ${CMAKE_BINARY_DIR}/pgo CACHE PATH "Directory for the profile data of profile guided optimization")
+set(XSAMPLES_ARCH "" CACHE STRING "Target architecture passed to -march, empty for the compiler default")
+
+if (XSAMPLES_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT XSAMPLES_IPO_SUPPORTED OUTPUT XSAMPLES_IPO_ERROR)
+    if (XSAMPLES_IPO_SUPPORTED)
+        set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+        message("Link time optimization enabled")
+    else ()
+        message(WARNING "Link time optimization not supported: ${XSAMPLES_IPO_ERROR}")
+    endif ()
+endif ()
+
+if (NOT XSAMPLES_PGO STREQUAL "OFF")
+    if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        if (XSAMPLES_PGO STREQUAL "GENERATE")
+            # Atomic counter updates because the samples run decoding and streaming on worker threads
+            add_compile_options(-fprofile-generate=${XSAMPLES_PGO_DIR} -fprofile-update=atomic)
+            add_link_options(-fprofile-generate=${XSAMPLES_PGO_DIR})
+        elseif (XSAMPLES_PGO STREQUAL "USE")
+            add_compile_options(-fprofile-use=${XSAMPLES_PGO_DIR} -fprofile-correction -Wno-missing-profile)
+            add_link_options(-fprofile-use=${XSAMPLES_PGO_DIR})
+        endif ()
+    elseif (CMAKE_CXX_COMPILER_ID STREQUAL "Clang")
+        if (XSAMPLES_PGO STREQUAL "GENERATE")
+            add_compile_options(-fprofile-generate=${XSAMPLES_PGO_DIR})
+            add_link_options(-fprofile-generate=${XSAMPLES_PGO_DIR})
+        elseif (XSAMPLES_PGO STREQUAL "USE")
+            # The raw profiles have to be merged first, see the pgo_merge target of the GENERATE build.
+            add_compile_options(-fprofile-use=${XSAMPLES_PGO_DIR}/default.profdata -Wno-profile-instr-unprofiled)
+            add_link_options(-fprofile-use=${XSAMPLES_PGO_DIR}/default.profdata)
+        endif ()
+        find_program(LLVM_PROFDATA llvm-profdata)
+        if (LLVM_PROFDATA)
+            add_custom_target(pgo_merge
+                    COMMAND ${LLVM_PROFDATA} merge -output=${XSAMPLES_PGO_DIR}/default.profdata ${XSAMPLES_PGO_DIR}
+                    WORKING_DIRECTORY ${XSAMPLES_PGO_DIR})
+        endif ()
+    else ()
+        message(WARNING "Profile guided optimization is not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif ()
+    message("Profile guided optimization: ${XSAMPLES_PGO}")
+endif ()
+
+if (NOT XSAMPLES_ARCH STREQUAL "")
+    if (CMAKE_CXX_COMPILER_ID STREQUAL "Clang" OR CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        add_compile_options(-march=${XSAMPLES_ARCH})
+        message("Target architecture: ${XSAMPLES_ARCH}")
+    endif ()
+endif ()
@@ -1,5 +1,8 @@
+include(cmake/common.cmake)
 include(cmake/sample0.cmake)
 include(cmake/assetexplorer.cmake)
+include(cmake/bench.cmake)
+include(cmake/softrender.cmake)
 
 # Copy Assets dir to binary dir
 set(Assets submodules/assets)
@@ -0,0 +1,8 @@
+# Headless software rendering of the sample0 scene, for machines without a gpu
+file(GLOB_RECURSE XSamplesSoftRender.SRC apps/softrender/src/*.cpp apps/softrender/src/*.c)
+add_executable(xsamples_softrender ${XSamplesSoftRender.SRC} ${XSamplesCommon.SRC})
+target_include_directories(xsamples_softrender PRIVATE apps/softrender/src/ apps/common/src/)
+target_link_libraries(xsamples_softrender xengine)
+if (OpenMP_CXX_FOUND)
+    target_link_libraries(xsamples_softrender OpenMP::OpenMP_CXX)
+endif ()